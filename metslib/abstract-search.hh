@@ -4,6 +4,7 @@
 // http://www.opensource.org/licenses/cpl1.0.php
 
 #include <iostream>
+#include <atomic>
 
 #ifndef METS_ABSTRACT_SEARCH_HH_
 #    define METS_ABSTRACT_SEARCH_HH_
@@ -43,6 +44,173 @@ class solution_recorder {
     virtual gol_type best_cost() const = 0;
 };
 
+/// @brief What a search is doing, as seen by its listeners (see
+/// mets::abstract_search::event()).
+///
+/// The search algorithms of the library fill it with values they
+/// already have at hand before notifying each step, so the listeners
+/// can read them without casts nor virtual calls. The values a
+/// search does not know are NaN (or -1 for the move index).
+struct search_event {
+    search_event()
+        : step(0),
+          iteration(0),
+          cost(std::numeric_limits<gol_type>::quiet_NaN()),
+          delta(std::numeric_limits<gol_type>::quiet_NaN()),
+          move_index(-1),
+          tabu(false),
+          aspiration(false),
+          parameter(std::numeric_limits<double>::quiet_NaN()) {}
+
+    /// @brief The notified step (see mets::abstract_search::step()).
+    int step;
+    /// @brief The iterations started by search() so far.
+    unsigned long iteration;
+    /// @brief The cost of the working solution after the last move
+    /// (of the candidate move when the aspiration criteria is met).
+    gol_type cost;
+    /// @brief The cost change of that move.
+    gol_type delta;
+    /// @brief The position of that move in the neighborhood scan.
+    long move_index;
+    /// @brief The move was tabu.
+    bool tabu;
+    /// @brief The move met the aspiration criteria.
+    bool aspiration;
+    /// @brief The main parameter of the search: the tabu list tenure
+    /// for mets::tabu_search, the temperature for
+    /// mets::simulated_annealing.
+    double parameter;
+};
+
+/// @brief What a search did: counters and (optionally) timings of
+/// its phases.
+///
+/// The counters accumulate over the calls to search() (see
+/// reset()). They are written by the thread running the search only
+/// (the parallel searches add the counts of their workers once per
+/// iteration), with relaxed atomic stores and no read-modify-write,
+/// and can be read from any thread, during and after search().
+///
+/// The timings need two clock reads per timed operation, so they are
+/// collected only when enabled with timing(true). The evaluation of
+/// the parallel searches is timed as a whole (wall clock time of the
+/// batch, tabu checks included).
+class search_statistics {
+  public:
+    enum counter {
+        /// @brief Moves evaluated.
+        MOVES_EVALUATED = 0,
+        /// @brief Evaluated moves found tabu.
+        TABU_HITS,
+        /// @brief Tabu moves chosen because they met the aspiration
+        /// criteria.
+        ASPIRATION_OVERRIDES,
+        /// @brief Moves applied to the working solution.
+        MOVES_ACCEPTED,
+        /// @brief Evaluated moves refused by the acceptance policy of
+        /// a simulated annealing.
+        MOVES_REJECTED,
+        /// @brief Moves improving the best solution.
+        IMPROVEMENTS,
+        /// @brief Refresh calls of the neighborhood.
+        REFRESHES,
+        /// @brief Nanoseconds spent refreshing the neighborhood.
+        REFRESH_NS,
+        /// @brief Nanoseconds spent evaluating the moves.
+        EVALUATE_NS,
+        /// @brief Nanoseconds spent in the tabu list (checks and
+        /// insertions).
+        TABU_NS,
+        /// @brief Nanoseconds spent applying the moves.
+        APPLY_NS,
+        /// @brief Nanoseconds spent notifying the observers.
+        NOTIFY_NS,
+        COUNTERS
+    };
+
+    search_statistics() : values_m(), timing_m(false) { reset(); }
+
+    /// purposely not implemented (see Effective C++)
+    search_statistics(const search_statistics &);
+    /// purposely not implemented (see Effective C++)
+    search_statistics &operator=(const search_statistics &);
+
+    /// @brief The value of a counter.
+    unsigned long long get(counter c) const { return values_m[c].load(std::memory_order_relaxed); }
+
+    /// @brief Adds to a counter (from the search thread only).
+    void add(counter c, unsigned long long n) {
+        values_m[c].store(values_m[c].load(std::memory_order_relaxed) + n,
+                          std::memory_order_relaxed);
+    }
+
+    /// @brief Sets all the counters to zero (not while searching).
+    void reset() {
+        for (int ii = 0; ii != COUNTERS; ++ii) values_m[ii].store(0, std::memory_order_relaxed);
+    }
+
+    /// @brief True if the phases are timed.
+    bool timing() const { return timing_m; }
+
+    /// @brief Enables or disables the timings (not while searching).
+    void timing(bool enabled) { timing_m = enabled; }
+
+    /// @brief Starts timing an operation: the current time in
+    /// nanoseconds, 0 if the timings are disabled.
+    unsigned long long start() const {
+        if (!timing_m) return 0;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+    }
+
+    /// @brief Adds the time elapsed since start to a timing counter.
+    void stop(counter c, unsigned long long start) {
+        if (timing_m) add(c, this->start() - start);
+    }
+
+    /// @brief Prints the non zero counters, one per line.
+    void print(std::ostream &os) const;
+
+  protected:
+    std::atomic<unsigned long long> values_m[COUNTERS];
+    bool timing_m;
+};
+
+/// @brief Called by the searches around the phases of each iteration
+/// (see mets::abstract_search::profiler()).
+///
+/// The phases do not nest: a phase ends before the next one begins.
+class phase_listener {
+  public:
+    enum phase {
+        /// @brief The refresh of the neighborhood.
+        REFRESH = 0,
+        /// @brief The scan of the neighborhood (evaluation, tabu
+        /// checks and aspiration criteria), up to the chosen move.
+        EVALUATE,
+        /// @brief The application of the chosen move.
+        APPLY,
+        PHASES
+    };
+
+    phase_listener() {}
+
+    /// purposely not implemented (see Effective C++)
+    phase_listener(const phase_listener &);
+    /// purposely not implemented (see Effective C++)
+    phase_listener &operator=(const phase_listener &);
+
+    virtual ~phase_listener() {}
+
+    /// @brief A phase begins.
+    virtual void phase_begin(int phase) = 0;
+
+    /// @brief The phase ends.
+    virtual void phase_end(int phase) = 0;
+};
+
 /// @brief An abstract search.
 ///
 /// @see mets::tabu_search, mets::simulated_annealing, mets::local_search
@@ -68,7 +236,12 @@ class abstract_search : public subject<abstract_search<move_manager_type> > {
           working_solution_m(working),
           moves_m(moveman),
           current_move_m(),
-          step_m() {}
+          step_m(),
+          event_m(),
+          evaluable_m(),
+          statistics_m(),
+          profiler_m(),
+          cancellation_m() {}
 
     /// purposely not implemented (see Effective C++)
     abstract_search(const abstract_search<move_manager_type> &);
@@ -127,12 +300,105 @@ class abstract_search : public subject<abstract_search<move_manager_type> > {
     /// (0 = "MOVE_MADE", 1 = "IMPROVEMENT_MADE", etc.).
     int step() const { return step_m; }
 
+    /// @brief The bit of a step in the event masks: listeners
+    ///        attached with attach(listener, mask) are only updated
+    ///        on the steps in the mask (e.g.
+    ///        step_mask(MOVE_MADE) | step_mask(ITERATION_END)).
+    static unsigned int step_mask(int step) { return 1u << step; }
+
+    /// @brief The details of the current step (to be used by the
+    ///        observers).
+    const search_event &event() const { return event_m; }
+
+    /// @brief What the search did so far.
+    search_statistics &statistics() { return statistics_m; }
+
+    /// @brief What the search did so far.
+    const search_statistics &statistics() const { return statistics_m; }
+
+    /// @brief Sets the listener called around the phases of each
+    /// iteration (0 to remove it).
+    ///
+    /// Without a profiler the phases cost a single test each.
+    void profiler(phase_listener *p) { profiler_m = p; }
+
+    /// @brief Sets the token checked by the search at iteration
+    /// boundaries: when a stop is requested search() returns (the
+    /// recorder holds the best solution found so far).
+    void cancellation(const cancellation_token &token) { cancellation_m = token; }
+
+    /// @brief The cancellation token of this search.
+    const cancellation_token &cancellation() const { return cancellation_m; }
+
+    /// @brief True if a stop was requested to this search.
+    bool stop_requested() const { return cancellation_m.stop_requested(); }
+
   protected:
+    /// @brief Sets the current step and notifies the listeners
+    ///        subscribed to it.
+    ///
+    /// Costs a single test when nobody listens to the step, and
+    /// nothing but the assignment of the step with the
+    /// mets::null_observer policy.
+    template <typename observer_policy = attached_observers>
+    void notify_step(int step) {
+        step_m = step;
+        event_m.step = step;
+        if (observer_policy::enabled && this->observed(step_mask(step))) {
+            unsigned long long start = statistics_m.start();
+            this->notify_events(step_mask(step));
+            statistics_m.stop(search_statistics::NOTIFY_NS, start);
+        }
+    }
+
+    /// @brief A phase begins (see mets::phase_listener).
+    void begin_phase(int phase) {
+        if (profiler_m) profiler_m->phase_begin(phase);
+    }
+
+    /// @brief The phase ends.
+    void end_phase(int phase) {
+        if (profiler_m) profiler_m->phase_end(phase);
+    }
+
+    /// @brief Starts a new search() in the event: no iterations,
+    /// the cost of the working solution if it is evaluable.
+    void start_event() {
+        event_m = search_event();
+        evaluable_m = dynamic_cast<const evaluable_solution *>(&working_solution_m);
+        if (evaluable_m) event_m.cost = evaluable_m->cost_function();
+    }
+
+    /// @brief Starts a new iteration in the event.
+    ///
+    /// The cost is read again from the working solution: the
+    /// listeners may have changed it since the last move.
+    void iteration_event(double parameter) {
+        ++event_m.iteration;
+        event_m.parameter = parameter;
+        if (evaluable_m) event_m.cost = evaluable_m->cost_function();
+    }
+
+    /// @brief Records a move (or a candidate move) in the event.
+    void move_event(long index, gol_type cost, gol_type delta, bool tabu = false,
+                    bool aspiration = false) {
+        event_m.move_index = index;
+        event_m.cost = cost;
+        event_m.delta = delta;
+        event_m.tabu = tabu;
+        event_m.aspiration = aspiration;
+    }
+
     solution_recorder &solution_recorder_m;
     feasible_solution &working_solution_m;
     move_manager_type &moves_m;
     typename move_manager_type::iterator current_move_m;
     int step_m;
+    search_event event_m;
+    const evaluable_solution *evaluable_m;
+    search_statistics statistics_m;
+    phase_listener *profiler_m;
+    cancellation_token cancellation_m;
 };
 
 /// @}
@@ -144,39 +410,57 @@ class abstract_search : public subject<abstract_search<move_manager_type> > {
 /// solution recorder that just records the best copyable solution
 /// found during its lifetime.
 ///
-class best_ever_solution : public solution_recorder {
+/// The solution_type is the type of the recorded solutions (a
+/// mets::evaluable_solution): accept() called with a solution_type
+/// does not need any cast (this is what happens when a search is
+/// instantiated on the concrete solution and recorder types). The
+/// mets::best_ever_solution records any mets::evaluable_solution.
+///
+template <typename solution_type>
+class basic_best_ever_solution : public solution_recorder {
   public:
-    /// @brief The mets::evaluable_solution will be stored as a
-    /// reference: please provide an instance that is not
-    /// modified/needed elsewhere.
+    /// @brief The solution will be stored as a reference: please
+    /// provide an instance that is not modified/needed elsewhere.
     ///
     /// @param best The instance used to store the best solution found
     /// (will be modified).
-    best_ever_solution(evaluable_solution &best) : solution_recorder(), best_ever_m(best) {}
+    basic_best_ever_solution(solution_type &best) : solution_recorder(), best_ever_m(best) {}
 
     /// @brief Unimplemented default ctor.
-    best_ever_solution();
+    basic_best_ever_solution();
     /// @brief Unimplemented copy ctor.
-    best_ever_solution(const best_ever_solution &);
+    basic_best_ever_solution(const basic_best_ever_solution &);
     /// @brief Unimplemented assignment operator.
-    best_ever_solution &operator=(const best_ever_solution &);
+    basic_best_ever_solution &operator=(const basic_best_ever_solution &);
 
     /// @brief Accept is called at the end of each iteration for an
     /// opportunity to record the best solution found during the
     /// search.
-    bool accept(const feasible_solution &sol);
+    ///
+    /// @param sol The current working solution (a solution_type).
+    /// @throw std::bad_cast if it is not.
+    bool accept(const feasible_solution &sol) {
+        return accept(dynamic_cast<const solution_type &>(sol));
+    }
+
+    /// @brief Statically typed version of accept().
+    bool accept(const solution_type &sol);
 
     /// @brief Returns the best solution found since the beginning.
-    const evaluable_solution &best_seen() const { return best_ever_m; }
+    const solution_type &best_seen() const { return best_ever_m; }
 
     /// @brief Best cost seen.
     gol_type best_cost() const { return best_ever_m.cost_function(); }
 
   protected:
     /// @brief Records the best solution
-    evaluable_solution &best_ever_m;
+    solution_type &best_ever_m;
 };
 
+/// @brief The best ever solution recorder for any
+/// mets::evaluable_solution.
+typedef basic_best_ever_solution<evaluable_solution> best_ever_solution;
+
 /// @brief An object that is called back during the search progress.
 template <typename move_manager_type>
 class search_listener : public observer<abstract_search<move_manager_type> > {
@@ -196,7 +480,19 @@ class search_listener : public observer<abstract_search<move_manager_type> > {
 
     /// @brief This is the callback method called by searches
     /// when a move, an improvement or something else happens
+    ///
+    /// The details of the step (cost, cost change and index of the
+    /// move, iteration, ...) are in algorithm->event().
     virtual void update(search_type *algorithm) = 0;
+
+  protected:
+    /// @brief The cost of the working solution: from the event when
+    /// the search fills it, from the (evaluable) solution otherwise.
+    static gol_type working_cost(const search_type *algorithm) {
+        const gol_type cost = algorithm->event().cost;
+        if (cost == cost) return cost;
+        return dynamic_cast<const evaluable_solution &>(algorithm->working()).cost_function();
+    }
 };
 
 template <typename neighborhood_t>
@@ -205,11 +501,8 @@ struct iteration_logger : public mets::search_listener<neighborhood_t> {
         : mets::search_listener<neighborhood_t>(), iteration(0), os(o) {}
 
     void update(mets::abstract_search<neighborhood_t> *as) {
-        const mets::feasible_solution &p = as->working();
-        if (as->step() == mets::abstract_search<neighborhood_t>::MOVE_MADE) {
-            os << iteration++ << "\t"
-               << dynamic_cast<const mets::evaluable_solution &>(p).cost_function() << "\n";
-        }
+        if (as->step() == mets::abstract_search<neighborhood_t>::MOVE_MADE)
+            os << iteration++ << "\t" << this->working_cost(as) << "\n";
     }
 
   protected:
@@ -227,11 +520,9 @@ struct improvement_logger : public mets::search_listener<neighborhood_t> {
           epsilon_m(epsilon) {}
 
     void update(mets::abstract_search<neighborhood_t> *as) {
-        const mets::feasible_solution &p = as->working();
-
         if (as->step() == mets::abstract_search<neighborhood_t>::MOVE_MADE) {
             iteration_m++;
-            double val = dynamic_cast<const mets::evaluable_solution &>(p).cost_function();
+            double val = this->working_cost(as);
             if (val < best_m - epsilon_m) {
                 best_m = val;
                 os_m << iteration_m << "\t" << best_m << " (*)\n";
@@ -252,8 +543,17 @@ struct improvement_logger : public mets::search_listener<neighborhood_t> {
 
 inline mets::solution_recorder::~solution_recorder() {}
 
-inline bool mets::best_ever_solution::accept(const mets::feasible_solution &sol) {
-    const evaluable_solution &s = dynamic_cast<const mets::evaluable_solution &>(sol);
+inline void mets::search_statistics::print(std::ostream &os) const {
+    static const char *names[COUNTERS] = {
+            "moves evaluated", "tabu hits",      "aspiration overrides", "moves accepted",
+            "moves rejected",  "improvements",   "refreshes",            "refresh ns",
+            "evaluate ns",     "tabu ns",        "apply ns",             "notify ns"};
+    for (int ii = 0; ii != COUNTERS; ++ii)
+        if (get(counter(ii))) os << names[ii] << "\t" << get(counter(ii)) << "\n";
+}
+
+template <typename solution_type>
+bool mets::basic_best_ever_solution<solution_type>::accept(const solution_type &s) {
     if (s.cost_function() < best_ever_m.cost_function()) {
         best_ever_m.copy_from(s);
         return true;
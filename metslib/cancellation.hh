@@ -0,0 +1,147 @@
+// METSlib source file - cancellation.hh                         -*- C++ -*-
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_CANCELLATION_HH_
+#define METS_CANCELLATION_HH_
+
+#include <atomic>
+#include <csignal>
+
+namespace mets {
+
+/// @defgroup common Common components
+/// @{
+
+class cancellation_source;
+
+/// @brief A view on a mets::cancellation_source, telling if a stop
+/// was requested.
+///
+/// A default constructed token is never stopped. The token does not
+/// own the source: the source must outlive its tokens.
+class cancellation_token {
+  public:
+    /// @brief A token that is never stopped.
+    cancellation_token() : flag_m(0) {}
+
+    /// @brief True if a stop was requested to the source.
+    bool stop_requested() const { return flag_m && flag_m->load(std::memory_order_acquire); }
+
+    /// @brief True if the token is bound to a source.
+    bool stop_possible() const { return flag_m != 0; }
+
+  protected:
+    friend class cancellation_source;
+    explicit cancellation_token(const std::atomic<bool> *flag) : flag_m(flag) {}
+
+    const std::atomic<bool> *flag_m;
+};
+
+/// @brief Cooperative cancellation of running searches.
+///
+/// The searches (see mets::abstract_search::cancellation()) check
+/// their token at iteration boundaries and return normally from
+/// search() when a stop is requested, leaving the solution recorder
+/// with the best solution found so far.
+///
+/// request_stop() is lock-free and can be called from any thread
+/// (and from a signal handler, see mets::signal_cancellation).
+class cancellation_source {
+  public:
+    cancellation_source() : flag_m(false) {}
+
+    /// purposely not implemented (see Effective C++)
+    cancellation_source(const cancellation_source &);
+    /// purposely not implemented (see Effective C++)
+    cancellation_source &operator=(const cancellation_source &);
+
+    /// @brief Requests the searches using this source to stop.
+    ///
+    /// @return True if this call made the request (false if a stop
+    /// was already requested).
+    bool request_stop() { return !flag_m.exchange(true, std::memory_order_acq_rel); }
+
+    /// @brief True if a stop was requested.
+    bool stop_requested() const { return flag_m.load(std::memory_order_acquire); }
+
+    /// @brief Withdraws the stop request (e.g. before a new solve).
+    void reset() { flag_m.store(false, std::memory_order_release); }
+
+    /// @brief A token bound to this source.
+    cancellation_token token() const { return cancellation_token(&flag_m); }
+
+  protected:
+    std::atomic<bool> flag_m;
+};
+
+/// @brief Requests a stop to a mets::cancellation_source when the
+/// process receives SIGINT or SIGTERM.
+///
+/// The handlers are installed by the constructor and the previous
+/// ones are restored by the destructor. Only one instance at a time
+/// can exist (a std::runtime_error is thrown otherwise).
+class signal_cancellation {
+  public:
+    explicit signal_cancellation(cancellation_source &source);
+
+    /// purposely not implemented (see Effective C++)
+    signal_cancellation(const signal_cancellation &);
+    /// purposely not implemented (see Effective C++)
+    signal_cancellation &operator=(const signal_cancellation &);
+
+    /// @brief Restores the previous handlers.
+    ~signal_cancellation();
+
+  protected:
+    static std::atomic<cancellation_source *> &current() {
+        static std::atomic<cancellation_source *> source(0);
+        return source;
+    }
+
+    static void handler(int) {
+        cancellation_source *source = current().load();
+        if (source) source->request_stop();
+    }
+
+    void (*previous_int_m)(int);
+    void (*previous_term_m)(int);
+};
+
+/// @}
+
+}  // namespace mets
+
+inline mets::signal_cancellation::signal_cancellation(cancellation_source &source)
+    : previous_int_m(), previous_term_m() {
+    cancellation_source *expected = 0;
+    if (!current().compare_exchange_strong(expected, &source))
+        throw std::runtime_error("signal_cancellation already installed");
+    previous_int_m = std::signal(SIGINT, &signal_cancellation::handler);
+    previous_term_m = std::signal(SIGTERM, &signal_cancellation::handler);
+    if (previous_int_m == SIG_ERR) previous_int_m = SIG_DFL;
+    if (previous_term_m == SIG_ERR) previous_term_m = SIG_DFL;
+}
+
+inline mets::signal_cancellation::~signal_cancellation() {
+    std::signal(SIGINT, previous_int_m);
+    std::signal(SIGTERM, previous_term_m);
+    current().store(0);
+}
+
+#endif
@@ -0,0 +1,339 @@
+// METSlib source file - island-search.hh                        -*- C++ -*-
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_ISLAND_SEARCH_HH_
+#define METS_ISLAND_SEARCH_HH_
+
+#include <atomic>
+#include <thread>
+#include <exception>
+
+namespace mets {
+
+/// @defgroup island_search Island model
+/// @{
+
+/// @brief Runs many independent searches (islands) in parallel,
+/// periodically migrating elite solutions between them.
+///
+/// Each island is a search (e.g. a mets::tabu_search with its own
+/// working solution, tabu list, tenure, random seed, ...) running on
+/// its own thread. Every time an island improves over its best
+/// solution the improved solution is copied in the island elite and
+/// its cost is published on a shared board, keeping the island with
+/// the best elite. Every migration_interval iterations
+/// an island sends its elite to the islands chosen by the topology,
+/// and takes the solution waiting in its own inbox, if any: when it
+/// is better than anything the island has seen the island continues
+/// its search from there.
+///
+/// The board and the migration queues are lock-free: the queue of
+/// an island is a single slot inbox, claimed with a compare and swap
+/// by the sending island and by the receiving one. No island ever
+/// waits for another: a migrant sent to a full inbox is dropped (the
+/// waiting one is received first), and the migrant waits in the
+/// inbox until its island comes to the migration.
+///
+/// The working solutions of the islands must be
+/// mets::evaluable_solution instances, all of the same type, and the
+/// searches must notify the IMPROVEMENT_MADE and ITERATION_END
+/// steps (as mets::tabu_search and mets::simulated_annealing do).
+template <typename move_manager_type>
+class island_search {
+  public:
+    typedef abstract_search<move_manager_type> search_type;
+
+    /// @brief The island the elite solutions are migrated from.
+    enum topology_type {
+        /// @brief The previous island (the last for the first one).
+        RING,
+        /// @brief The island holding the best solution.
+        BROADCAST_BEST
+    };
+
+    /// @brief Creates an island model.
+    ///
+    /// @param recorder The recorder that is given the best solution
+    /// of every island at the end of the search.
+    ///
+    /// @param migration_interval Number of iterations between two
+    /// migrations to an island.
+    ///
+    /// @param topology The migration topology.
+    ///
+    /// @param epsilon Minimum improvement for a migration.
+    island_search(solution_recorder &recorder, unsigned int migration_interval,
+                  topology_type topology = RING, gol_type epsilon = 1e-7);
+
+    /// purposely not implemented (see Effective C++)
+    island_search(const island_search &);
+    /// purposely not implemented (see Effective C++)
+    island_search &operator=(const island_search &);
+
+    /// @brief Detaches from the searches.
+    ~island_search();
+
+    /// @brief Adds an island.
+    ///
+    /// @param search The search run by the island (it must not be
+    /// shared with other islands).
+    ///
+    /// @param elite The instance used to store the best solution of
+    /// the island (will be modified, must be of the same type of the
+    /// working solutions of the searches).
+    ///
+    /// @param inbox The instance used to store the solutions migrating
+    /// to the island (will be modified, of the same type).
+    void add_island(search_type &search, evaluable_solution &elite, evaluable_solution &inbox);
+
+    /// @brief Runs all the islands and waits for them to terminate.
+    ///
+    /// The first island runs on the calling thread. If the search of
+    /// an island throws, the first exception is rethrown once all
+    /// the islands are done.
+    void search();
+
+    /// @brief Number of islands.
+    unsigned int size() const { return islands_m.size(); }
+
+    /// @brief Best cost published on the board.
+    gol_type best_cost() const {
+        return islands_m.empty() ? std::numeric_limits<gol_type>::max()
+                                 : islands_m[best_island_m.load()].elite_cost_m.load();
+    }
+
+    /// @brief Number of migrations done.
+    unsigned long migrations() const { return migrations_m.load(); }
+
+  protected:
+    /// @brief The listener of an island search: publishes and
+    /// imports the elite solutions.
+    class island : public search_listener<move_manager_type> {
+      public:
+        /// @brief The states of the inbox.
+        enum { EMPTY, WRITING, FULL, READING };
+
+        island(island_search &owner, unsigned int index, search_type &search,
+               evaluable_solution &elite, evaluable_solution &inbox);
+
+        void update(search_type *search);
+
+        /// @brief Copies the given solution in the elite and publishes
+        /// its cost (from the island thread only).
+        void publish(const evaluable_solution &sol);
+
+        /// @brief Sends the elite to the other island, if its inbox is
+        /// empty and the elite is better than its one.
+        void send(island &to);
+
+        /// @brief Copies the solution waiting in the inbox into sol,
+        /// if it is better than limit, and empties the inbox.
+        bool receive(evaluable_solution &sol, gol_type limit);
+
+        island_search &owner_m;
+        unsigned int index_m;
+        search_type &search_m;
+        evaluable_solution &elite_m;
+        evaluable_solution &inbox_m;
+        std::atomic<gol_type> elite_cost_m;
+        std::atomic<int> inbox_state_m;
+        unsigned long iteration_m;
+        gol_type imported_m;
+    };
+
+    /// @brief Updates the board with the elite of an island.
+    ///
+    /// The board holds the index of the best island only, its cost is
+    /// the elite cost of that island: as the elite costs only go
+    /// down, the island stays on the board until a better one takes
+    /// its place.
+    void publish(unsigned int index, gol_type cost);
+
+    /// @brief Sends the elite of the index-th island to the islands
+    /// chosen by the topology.
+    void migrate(unsigned int index);
+
+    solution_recorder &recorder_m;
+    unsigned int interval_m;
+    topology_type topology_m;
+    gol_type epsilon_m;
+    std::deque<island> islands_m;
+    std::atomic<unsigned int> best_island_m;
+    std::atomic<unsigned long> migrations_m;
+};
+
+/// @}
+
+}  // namespace mets
+
+template <typename move_manager_t>
+mets::island_search<move_manager_t>::island_search(solution_recorder &recorder,
+                                                   unsigned int migration_interval,
+                                                   topology_type topology, gol_type epsilon)
+    : recorder_m(recorder),
+      interval_m(migration_interval),
+      topology_m(topology),
+      epsilon_m(epsilon),
+      islands_m(),
+      best_island_m(0),
+      migrations_m(0) {}
+
+template <typename move_manager_t>
+mets::island_search<move_manager_t>::~island_search() {
+    for (typename std::deque<island>::iterator it = islands_m.begin(); it != islands_m.end();
+         ++it)
+        it->search_m.detach(*it);
+}
+
+template <typename move_manager_t>
+void mets::island_search<move_manager_t>::add_island(search_type &search,
+                                                     evaluable_solution &elite,
+                                                     evaluable_solution &inbox) {
+    islands_m.emplace_back(*this, islands_m.size(), search, elite, inbox);
+    search.attach(islands_m.back(), search_type::step_mask(search_type::IMPROVEMENT_MADE) |
+                                            search_type::step_mask(search_type::ITERATION_END));
+}
+
+template <typename move_manager_t>
+void mets::island_search<move_manager_t>::search() {
+    if (islands_m.empty()) return;
+    best_island_m.store(0);
+    for (typename std::deque<island>::iterator it = islands_m.begin(); it != islands_m.end();
+         ++it) {
+        const evaluable_solution &working =
+                static_cast<const evaluable_solution &>(it->search_m.working());
+        it->iteration_m = 0;
+        it->imported_m = std::numeric_limits<gol_type>::max();
+        it->inbox_state_m.store(island::EMPTY);
+        it->publish(working);
+    }
+
+    std::vector<std::exception_ptr> errors(islands_m.size());
+    std::vector<std::thread> threads;
+    threads.reserve(islands_m.size() - 1);
+    for (unsigned int ii = 1; ii < islands_m.size(); ++ii)
+        threads.push_back(std::thread([this, ii, &errors]() {
+            try {
+                islands_m[ii].search_m.search();
+            } catch (...) {
+                errors[ii] = std::current_exception();
+            }
+        }));
+    try {
+        islands_m[0].search_m.search();
+    } catch (...) {
+        errors[0] = std::current_exception();
+    }
+    for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+        it->join();
+    for (std::vector<std::exception_ptr>::iterator it = errors.begin(); it != errors.end(); ++it)
+        if (*it) std::rethrow_exception(*it);
+
+    for (typename std::deque<island>::iterator it = islands_m.begin(); it != islands_m.end();
+         ++it)
+        recorder_m.accept(it->elite_m);
+}
+
+template <typename move_manager_t>
+void mets::island_search<move_manager_t>::publish(unsigned int index, gol_type cost) {
+    unsigned int best = best_island_m.load();
+    while (best != index && cost < islands_m[best].elite_cost_m.load()) {
+        if (best_island_m.compare_exchange_weak(best, index)) break;
+    }
+}
+
+template <typename move_manager_t>
+void mets::island_search<move_manager_t>::migrate(unsigned int index) {
+    const unsigned int size = islands_m.size();
+    switch (topology_m) {
+        case BROADCAST_BEST:
+            if (best_island_m.load() != index) return;
+            for (unsigned int to = 0; to != size; ++to)
+                if (to != index) islands_m[index].send(islands_m[to]);
+            break;
+        case RING:
+        default:
+            if (size > 1) islands_m[index].send(islands_m[(index + 1) % size]);
+    }
+}
+
+template <typename move_manager_t>
+mets::island_search<move_manager_t>::island::island(island_search &owner, unsigned int index,
+                                                    search_type &search,
+                                                    evaluable_solution &elite,
+                                                    evaluable_solution &inbox)
+    : search_listener<move_manager_t>(),
+      owner_m(owner),
+      index_m(index),
+      search_m(search),
+      elite_m(elite),
+      inbox_m(inbox),
+      elite_cost_m(std::numeric_limits<gol_type>::max()),
+      inbox_state_m(EMPTY),
+      iteration_m(0),
+      imported_m(std::numeric_limits<gol_type>::max()) {}
+
+template <typename move_manager_t>
+void mets::island_search<move_manager_t>::island::update(search_type *search) {
+    evaluable_solution &working = static_cast<evaluable_solution &>(search->working());
+    if (search->step() == search_type::IMPROVEMENT_MADE) {
+        publish(working);
+    } else if (search->step() == search_type::ITERATION_END && owner_m.interval_m &&
+               ++iteration_m % owner_m.interval_m == 0) {
+        owner_m.migrate(index_m);
+        gol_type limit = std::min(imported_m, search->recorder().best_cost()) - owner_m.epsilon_m;
+        if (receive(working, limit)) {
+            imported_m = working.cost_function();
+            ++owner_m.migrations_m;
+        }
+    }
+}
+
+template <typename move_manager_t>
+void mets::island_search<move_manager_t>::island::publish(const evaluable_solution &sol) {
+    gol_type cost = sol.cost_function();
+    elite_m.copy_from(sol);
+    elite_cost_m.store(cost);
+    owner_m.publish(index_m, cost);
+}
+
+template <typename move_manager_t>
+void mets::island_search<move_manager_t>::island::send(island &to) {
+    // only the island thread writes the elite: no need to lock it
+    if (elite_cost_m.load() >= to.elite_cost_m.load() - owner_m.epsilon_m) return;
+    int state = EMPTY;
+    if (!to.inbox_state_m.compare_exchange_strong(state, WRITING, std::memory_order_acquire))
+        return;
+    to.inbox_m.copy_from(elite_m);
+    to.inbox_state_m.store(FULL, std::memory_order_release);
+}
+
+template <typename move_manager_t>
+bool mets::island_search<move_manager_t>::island::receive(evaluable_solution &sol,
+                                                          gol_type limit) {
+    int state = FULL;
+    if (!inbox_state_m.compare_exchange_strong(state, READING, std::memory_order_acquire))
+        return false;
+    bool better = inbox_m.cost_function() < limit;
+    if (better) sol.copy_from(inbox_m);
+    inbox_state_m.store(EMPTY, std::memory_order_release);
+    return better;
+}
+
+#endif
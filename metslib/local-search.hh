@@ -33,9 +33,15 @@ namespace mets {
 /// and move managers generated neighborhood this can be used to do
 /// also a Random Restart Local Search, a Greedy Search,
 /// an Iterated Local Search and a Variable Neighborhood Search.
-template <typename move_manager_type>
+///
+/// The solution_type and recorder_type can be used (or deduced) to
+/// instantiate the search on the concrete types, as for
+/// mets::tabu_search.
+template <typename move_manager_type, typename solution_type = evaluable_solution,
+          typename recorder_type = solution_recorder>
 class local_search : public mets::abstract_search<move_manager_type> {
   public:
+    typedef local_search<move_manager_type, solution_type, recorder_type> search_type;
     /// @brief Creates a local search instance
     ///
     /// @param working The working solution (this will be modified
@@ -49,12 +55,12 @@ class local_search : public mets::abstract_search<move_manager_type> {
     ///
     /// @param short_circuit Wether the search should stop on
     /// the first improving move or not.
-    local_search(evaluable_solution &starting_point, solution_recorder &recorder,
+    local_search(solution_type &starting_point, recorder_type &recorder,
                  move_manager_type &moveman, gol_type epsilon = 1e-7, bool short_circuit = false);
 
     /// purposely not implemented (see Effective C++)
-    local_search(const local_search &);
-    local_search &operator=(const local_search &);
+    local_search(const search_type &);
+    search_type &operator=(const search_type &);
 
     /// @brief This method starts the local search process.
     ///
@@ -65,6 +71,8 @@ class local_search : public mets::abstract_search<move_manager_type> {
     virtual void search();
 
   protected:
+    solution_type &working_m;
+    recorder_type &recorder_m;
     bool short_circuit_m;
     gol_type epsilon_m;
 };
@@ -73,49 +81,79 @@ class local_search : public mets::abstract_search<move_manager_type> {
 
 }  // namespace mets
 
-template <typename move_manager_t>
-mets::local_search<move_manager_t>::local_search(evaluable_solution &working,
-                                                 solution_recorder &recorder,
-                                                 move_manager_t &moveman, gol_type epsilon,
-                                                 bool short_circuit)
+template <typename move_manager_t, typename solution_t, typename recorder_t>
+mets::local_search<move_manager_t, solution_t, recorder_t>::local_search(solution_t &working,
+                                                                         recorder_t &recorder,
+                                                                         move_manager_t &moveman,
+                                                                         gol_type epsilon,
+                                                                         bool short_circuit)
     : abstract_search<move_manager_t>(working, recorder, moveman),
+      working_m(working),
+      recorder_m(recorder),
       short_circuit_m(short_circuit),
       epsilon_m(epsilon) {
     typedef abstract_search<move_manager_t> base_t;
     base_t::step_m = 0;
 }
 
-template <typename move_manager_t>
-void mets::local_search<move_manager_t>::search() {
+template <typename move_manager_t, typename solution_t, typename recorder_t>
+void mets::local_search<move_manager_t, solution_t, recorder_t>::search() {
     typedef abstract_search<move_manager_t> base_t;
+    search_statistics &stats = base_t::statistics_m;
     typename move_manager_t::iterator best_movit;
 
-    base_t::solution_recorder_m.accept(base_t::working_solution_m);
+    recorder_m.accept(working_m);
 
-    gol_type best_cost =
-            static_cast<mets::evaluable_solution &>(base_t::working_solution_m).cost_function();
+    gol_type best_cost = working_m.cost_function();
 
+    this->start_event();
     do {
-        base_t::moves_m.refresh(base_t::working_solution_m);
+        this->iteration_event(std::numeric_limits<double>::quiet_NaN());
+        const gol_type current_cost = best_cost;
+        long index = 0;
+        long best_index = -1;
+
+        this->begin_phase(phase_listener::REFRESH);
+        unsigned long long start = stats.start();
+        base_t::moves_m.refresh(working_m);
+        stats.stop(search_statistics::REFRESH_NS, start);
+        stats.add(search_statistics::REFRESHES, 1);
+        this->end_phase(phase_listener::REFRESH);
+
+        this->begin_phase(phase_listener::EVALUATE);
         best_movit = base_t::moves_m.end();
         for (typename move_manager_t::iterator movit = base_t::moves_m.begin();
-             movit != base_t::moves_m.end(); ++movit) {
+             movit != base_t::moves_m.end(); ++movit, ++index) {
             // evaluate the cost after the move
-            gol_type cost = (*movit)->evaluate(base_t::working_solution_m);
+            start = stats.start();
+            gol_type cost = (*movit)->evaluate(working_m);
+            stats.stop(search_statistics::EVALUATE_NS, start);
             if (cost < best_cost - epsilon_m) {
                 best_cost = cost;
                 best_movit = movit;
-                if (short_circuit_m) break;
+                best_index = index;
+                if (short_circuit_m) {
+                    ++index;
+                    break;
+                }
             }
         }  // end for each move
+        stats.add(search_statistics::MOVES_EVALUATED, index);
+        this->end_phase(phase_listener::EVALUATE);
 
         if (best_movit != base_t::moves_m.end()) {
-            (*best_movit)->apply(base_t::working_solution_m);
-            base_t::solution_recorder_m.accept(base_t::working_solution_m);
+            this->begin_phase(phase_listener::APPLY);
+            start = stats.start();
+            (*best_movit)->apply(working_m);
+            stats.stop(search_statistics::APPLY_NS, start);
+            this->end_phase(phase_listener::APPLY);
+            stats.add(search_statistics::MOVES_ACCEPTED, 1);
+            if (recorder_m.accept(working_m)) stats.add(search_statistics::IMPROVEMENTS, 1);
             base_t::current_move_m = best_movit;
-            this->notify();
+            this->move_event(best_index, best_cost, best_cost - current_cost);
+            this->notify_step(base_t::MOVE_MADE);
         }
 
-    } while (best_movit != base_t::moves_m.end());
+    } while (best_movit != base_t::moves_m.end() && !this->stop_requested());
 }
 #endif
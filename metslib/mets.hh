@@ -65,31 +65,79 @@
 ///
 /// - mets::move_manager (or a class implementing the same concept)
 ///   - mets::swap_neighborhood
+///   - mets::implicit_neighborhood
+///     - mets::implicit_swap_neighborhood
+///     - mets::implicit_invert_neighborhood
+///     - mets::random_swap_neighborhood
 /// - mets::local_search
 /// - mets::simulated_annealing
 ///   - mets::abstract_cooling_schedule
+///     - mets::exponential_cooling, mets::linear_cooling
+///     - mets::lam_cooling
+///     - mets::reheating_cooling
+///   - mets::metropolis_acceptance, mets::threshold_acceptance
+///   - mets::calibrate_temperature()
 ///   - mets::solution_recorder
 ///     - mets::best_ever_solution
 ///   - mets::termination_criteria_chain
 ///     - mets::iteration_termination_criteria
 ///     - mets::noimprove_termination_criteria
 ///     - mets::threshold_termination_criteria
+///     - mets::deadline_termination_criteria
+///     - mets::cpu_time_termination_criteria
+///   - mets::termination_any, mets::termination_all (with
+///     mets::termination_criteria_adapter)
+/// - mets::parallel_simulated_annealing
+/// - mets::parallel_tempering
 /// - mets::tabu_search
 ///   - mets::tabu_list_chain
 ///     - mets::simple_tabu_list
+///     - mets::flat_tabu_list
+///     - mets::swap_tabu_matrix
+///     - mets::element_position_tabu_list
 ///   - mets::aspiration_criteria_chain
 ///     - mets::best_ever_criteria
+///   - mets::reactive_tabu_listener
 ///   - mets::solution_recorder
 ///     - mets::best_ever_solution
 ///   - mets::termination_criteria_chain
 ///     - mets::iteration_termination_criteria
 ///     - mets::noimprove_termination_criteria
 ///     - mets::threshold_termination_criteria
+///     - mets::deadline_termination_criteria
+///     - mets::cpu_time_termination_criteria
+/// - mets::parallel_tabu_search
+///   - mets::thread_pool
+/// - mets::island_search
+///
+/// Listeners can be attached to a search for some of its steps only
+/// (see mets::abstract_search::step_mask()), and the
+/// mets::null_observer policy removes the notifications from a
+/// mets::tabu_search at compile time. The listeners find the details of
+/// each step (cost and index of the move, tenure or temperature, ...)
+/// in a mets::search_event, and a mets::trace_listener records them
+/// in a binary file from a background thread (mets::trace_writer).
+/// Each search counts what it did (evaluated moves, tabu hits,
+/// refreshes, ...) and optionally times its phases in a
+/// mets::search_statistics (see mets::abstract_search::statistics()),
+/// and a mets::perf_profiler measures its phases with the hardware
+/// performance counters.
+///
+/// Running searches can be stopped from another thread (or by
+/// SIGINT/SIGTERM, see mets::signal_cancellation) through a
+/// mets::cancellation_source.
 ///
 /// To use the mets::simple_tabu_list you need to derive your moves
 /// from the mets::mana_move base class and implement the pure virtual
 /// methods.
 ///
+/// The search algorithms are templates on the types of the solution
+/// and of their components too: with C++17 class template argument
+/// deduction a search built from concrete components (e.g.
+/// mets::basic_best_ever_solution<my_problem>,
+/// mets::basic_best_ever_criteria<my_problem>, mets::swap_tabu_matrix)
+/// calls them without virtual dispatch and without dynamic_cast.
+///
 #ifndef METS_METS_HH_
 #define METS_METS_HH_
 
@@ -97,12 +145,20 @@
 
 #include <list>
 #include <cmath>
+#include <chrono>
+#include <ctime>
 #include <deque>
 #include <limits>
+#include <iterator>
+#include <memory_resource>
+#include <cstddef>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 #include <cassert>
 #include <typeinfo>
+#include <functional>
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
@@ -127,10 +183,17 @@
 #include "observer.hh"
 #include "model.hh"
 #include "termination-criteria.hh"
+#include "cancellation.hh"
 #include "abstract-search.hh"
+#include "thread-pool.hh"
 #include "local-search.hh"
 #include "tabu-search.hh"
+#include "reactive-search.hh"
 #include "simulated-annealing.hh"
+#include "parallel-tempering.hh"
+#include "island-search.hh"
+#include "trace.hh"
+#include "profiler.hh"
 
 //________________________________________________________________________
 inline std::ostream &operator<<(std::ostream &os, const mets::printable &p) {
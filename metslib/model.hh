@@ -39,6 +39,14 @@ class no_moves_error : public std::runtime_error {
     no_moves_error(const std::string message) : std::runtime_error(message) {}
 };
 
+/// @brief A strong 64 bit mixing function (the splitmix64
+/// finalizer), each input bit affects all the output bits.
+inline unsigned long long mix64(unsigned long long x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
 /// @brief A sequence function object useful as an STL generator.
 ///
 /// Returns start, start+1, ...
@@ -142,14 +150,31 @@ class evaluable_solution : public feasible_solution, public copyable {
 /// perturbate a solution with some random swaps and to simply swap
 /// two items in the list.
 ///
+/// An optional cache of the cost change of every swap can be
+/// enabled with enable_delta_cache(): mets::swap_elements moves then
+/// read their evaluation from the cache and apply_swap() keeps it up
+/// to date calling update_delta() for each pair not involving the
+/// swapped positions (and evaluate_swap() for the others). For
+/// problems like the QAP, where update_delta() can be computed in
+/// O(1) (see Taillard, 1991), evaluating the full swap neighborhood
+/// costs O(n^2) instead of O(n^3).
+///
+/// An optional 64 bit Zobrist hash of the permutation (the xor of a
+/// random key for each element/position pair) can be enabled with
+/// enable_hash(): apply_swap() then keeps it up to date in O(1), and
+/// hash() returns it without scanning the permutation. It can be
+/// used as a fingerprint of the solution, e.g. to detect cycles (see
+/// mets::reactive_tabu_listener) or to memoise evaluations.
+///
 /// @see mets::swap_elements
-class permutation_problem : public evaluable_solution {
+class permutation_problem : public evaluable_solution, public hashable {
   public:
     /// @brief Unimplemented.
     permutation_problem();
 
     /// @brief Inizialize pi_m = {0, 1, 2, ..., n-1}.
-    permutation_problem(int n) : pi_m(n), cost_m(0.0) {
+    permutation_problem(int n)
+        : pi_m(n), cost_m(0.0), delta_cache_m(false), delta_m(), hash_enabled_m(false), hash_m(0) {
         std::generate(pi_m.begin(), pi_m.end(), sequence(0));
     }
 
@@ -182,26 +207,134 @@ class permutation_problem : public evaluable_solution {
     /// Do not override unless you know what you are doing.
     size_t size() const { return pi_m.size(); }
 
+    /// @brief The element at position i.
+    int pi(int i) const { return pi_m[i]; }
+
     /// @brief Returns the cost of the current solution. The default
     /// implementation provided returns the protected
     /// mets::permutation_problem::cost_m member variable. Do not
     /// override unless you know what you are doing.
     gol_type cost_function() const { return cost_m; }
 
-    /// @brief Updates the cost with the one computed by the subclass.
+    /// @brief Updates the cost with the one computed by the subclass
+    /// (and the swap delta cache, if enabled).
     /// Do not override unless you know what you are doing.
-    void update_cost() { cost_m = compute_cost(); }
+    void update_cost() {
+        cost_m = compute_cost();
+        if (delta_cache_m) refresh_delta_cache();
+        if (hash_enabled_m) refresh_hash();
+    }
 
     /// @brief: Apply a swap and update the cost.
     /// Do not override unless you know what you are doing.
     void apply_swap(int i, int j) {
-        cost_m += evaluate_swap(i, j);
+        cost_m += swap_delta(i, j);
+        if (hash_enabled_m) hash_m ^= swap_hash(i, j);
         std::swap(pi_m[i], pi_m[j]);
+        if (delta_cache_m) update_delta_cache(i, j);
+    }
+
+    /// @brief The cost change of swapping i and j: the cached value
+    /// when the delta cache is enabled, evaluate_swap() otherwise.
+    gol_type swap_delta(int i, int j) const {
+        return delta_cache_m ? delta_m[delta_index(i, j)] : evaluate_swap(i, j);
+    }
+
+    /// @brief Updated cost change of the swap (i, j) after the swap
+    /// (r, s) was applied.
+    ///
+    /// This is called by apply_swap(), when the delta cache is
+    /// enabled, for each pair (i, j) disjoint from (r, s) (with i <
+    /// j). The solution is the one after the swap. Override this to
+    /// exploit the structure of your problem: the default
+    /// implementation simply calls evaluate_swap(i, j).
+    ///
+    /// @param i The first position of the swap to update
+    /// @param j The second position of the swap to update
+    /// @param r The first position of the applied swap
+    /// @param s The second position of the applied swap
+    /// @param delta The cost change of (i, j) before the applied swap
+    /// @return The cost change of (i, j) now
+    virtual gol_type update_delta(int i, int j, int r, int s, gol_type delta) const {
+        return evaluate_swap(i, j);
+    }
+
+    /// @brief Enables the swap delta cache (O(n^2) memory).
+    void enable_delta_cache() {
+        delta_cache_m = true;
+        refresh_delta_cache();
+    }
+
+    /// @brief True if the swap delta cache is enabled.
+    bool delta_cache() const { return delta_cache_m; }
+
+    /// @brief Recomputes the whole delta cache with evaluate_swap().
+    ///
+    /// Not needed unless pi_m is modified without apply_swap() or
+    /// update_cost().
+    void refresh_delta_cache();
+
+    /// @brief Enables the incremental Zobrist hash.
+    void enable_hash() {
+        hash_enabled_m = true;
+        refresh_hash();
+    }
+
+    /// @brief True if the incremental hash is enabled.
+    bool hash_enabled() const { return hash_enabled_m; }
+
+    /// @brief The Zobrist hash of the permutation: O(1) when the
+    /// incremental hash is enabled, O(n) otherwise.
+    size_t hash() const { return static_cast<size_t>(hash_enabled_m ? hash_m : compute_hash()); }
+
+    /// @brief The hash the permutation would have after swapping i
+    /// and j, without doing the swap (O(1) when the incremental hash
+    /// is enabled).
+    size_t peek_hash_after_swap(int i, int j) const {
+        return static_cast<size_t>((hash_enabled_m ? hash_m : compute_hash()) ^ swap_hash(i, j));
+    }
+
+    /// @brief Recomputes the incremental hash.
+    ///
+    /// Not needed unless pi_m is modified without apply_swap() or
+    /// update_cost().
+    void refresh_hash() { hash_m = compute_hash(); }
+
+    /// @brief The random key of element e at position p.
+    static unsigned long long zobrist_key(int e, int p) {
+        return mix64((static_cast<unsigned long long>(e) << 32 | static_cast<unsigned int>(p)) +
+                     0x9e3779b97f4a7c15ULL);
     }
 
   protected:
+    /// @brief The hash computed from scratch.
+    unsigned long long compute_hash() const {
+        unsigned long long h = 0;
+        for (size_t ii = 0; ii != pi_m.size(); ++ii) h ^= zobrist_key(pi_m[ii], ii);
+        return h;
+    }
+
+    /// @brief The change of the hash when swapping i and j.
+    unsigned long long swap_hash(int i, int j) const {
+        const int a = pi_m[i], b = pi_m[j];
+        return zobrist_key(a, i) ^ zobrist_key(b, j) ^ zobrist_key(b, i) ^ zobrist_key(a, j);
+    }
+
+    /// @brief Index of the (i, j) swap in the delta cache.
+    static size_t delta_index(int i, int j) {
+        if (i > j) std::swap(i, j);
+        return size_t(j) * (j - 1) / 2 + i;
+    }
+
+    /// @brief Updates the delta cache after the swap (r, s).
+    void update_delta_cache(int r, int s);
+
     std::vector<int> pi_m;
     gol_type cost_m;
+    bool delta_cache_m;
+    std::vector<gol_type> delta_m;
+    bool hash_enabled_m;
+    unsigned long long hash_m;
     template <typename random_generator>
     friend void random_shuffle(permutation_problem &p, random_generator &rng);
 };
@@ -212,14 +345,13 @@ class permutation_problem : public evaluable_solution {
 template <typename random_generator>
 void random_shuffle(permutation_problem &p, random_generator &rng) {
 #if defined(METSLIB_HAVE_UNORDERED_MAP) && !defined(METSLIB_TR1_MIXED_NAMESPACE)
-    std::uniform_int_distribution<size_t> unigen;
-    auto gen = std::bind(unigen, rng);
+    std::shuffle(p.pi_m.begin(), p.pi_m.end(), rng);
 #else
     std::tr1::uniform_int<size_t> unigen;
     std::tr1::variate_generator<random_generator &, std::tr1::uniform_int<size_t> > gen(rng,
                                                                                         unigen);
-#endif
     std::shuffle(p.pi_m.begin(), p.pi_m.end(), gen);
+#endif
     p.update_cost();
 }
 
@@ -229,16 +361,22 @@ void random_shuffle(permutation_problem &p, random_generator &rng) {
 template <typename random_generator>
 void perturbate(permutation_problem &p, unsigned int n, random_generator &rng) {
 #if defined(METSLIB_HAVE_UNORDERED_MAP) && !defined(METSLIB_TR1_MIXED_NAMESPACE)
-    std::uniform_int_distribution<> int_range;
+    std::uniform_int_distribution<> int_range(0, p.size() - 1);
+    for (unsigned int ii = 0; ii != n; ++ii) {
+        int p1 = int_range(rng);
+        int p2 = int_range(rng);
+        while (p1 == p2) p2 = int_range(rng);
+        p.apply_swap(p1, p2);
+    }
 #else
     std::tr1::uniform_int<> int_range;
-#endif
     for (unsigned int ii = 0; ii != n; ++ii) {
         int p1 = int_range(rng, p.size());
         int p2 = int_range(rng, p.size());
         while (p1 == p2) p2 = int_range(rng, p.size());
         p.apply_swap(p1, p2);
     }
+#endif
 }
 
 /// @brief Move to be operated on a feasible solution.
@@ -270,6 +408,37 @@ class move {
     virtual void apply(feasible_solution &sol) const = 0;
 };
 
+/// @brief A fixed size identity of a mets::mana_move.
+///
+/// Two moves with the same key are the same move w.r.t. the tabu
+/// list: the mets::flat_tabu_list stores keys instead of clones of
+/// the moves.
+///
+/// The kind tells apart the move types, the value the moves of a
+/// type. The kinds below 256 are reserved to the library moves.
+struct move_key {
+    /// @brief An empty key.
+    move_key() : kind(0), value(0) {}
+
+    /// @brief The key of the move of the given kind and value.
+    move_key(unsigned long long k, unsigned long long v) : kind(k), value(v) {}
+
+    /// @brief The key of a move with two integer parameters.
+    static move_key pair(unsigned long long k, int a, int b) {
+        return move_key(k, static_cast<unsigned long long>(static_cast<unsigned int>(a)) << 32 |
+                                   static_cast<unsigned int>(b));
+    }
+
+    bool operator==(const move_key &o) const { return value == o.value && kind == o.kind; }
+    bool operator!=(const move_key &o) const { return !(*this == o); }
+
+    /// @brief A well mixed 64 bit hash of the key.
+    unsigned long long hash() const { return mix64(value ^ mix64(kind)); }
+
+    unsigned long long kind;   ///< the type of the move
+    unsigned long long value;  ///< the parameters of the move
+};
+
 /// @brief A Mana Move is a move that can be automatically made tabu
 /// by the mets::simple_tabu_list.
 ///
@@ -299,6 +468,52 @@ class mana_move : public move, public clonable, public hashable {
     /// @brief Tell if this move equals another w.r.t. the tabu list
     /// management (for mets::simple_tabu_list)
     virtual bool operator==(const mana_move &other) const = 0;
+
+    /// @brief The key of this move (for mets::flat_tabu_list).
+    ///
+    /// Must be consistent with operator==(). The default
+    /// implementation throws: moves made tabu by a
+    /// mets::flat_tabu_list must override it.
+    virtual move_key key() const {
+        throw std::runtime_error(std::string("mets::mana_move::key() not implemented by ") +
+                                 typeid(*this).name());
+    }
+
+    /// @brief The key of the move opposite_of() would return.
+    ///
+    /// By default the key() of this move: if you override
+    /// opposite_of() you should override this as well.
+    virtual move_key opposite_key() const { return key(); }
+
+    /// @brief Creates the move opposite_of() would return in memory
+    /// taken from resource (for mets::simple_tabu_list).
+    ///
+    /// Override it with create_in() to keep the moves made tabu by a
+    /// mets::simple_tabu_list in the pool of the list: the default
+    /// implementation returns 0 and the list falls back to
+    /// opposite_of(). A move that overrides opposite_of() (or the
+    /// clone() it calls) must override this together with it, or
+    /// return 0.
+    virtual mana_move *opposite_in(std::pmr::memory_resource &resource) const {
+        (void)resource;
+        return 0;
+    }
+
+    /// @brief Destroys a move made by create_in() and gives its memory
+    /// back to resource.
+    static void destroy_in(std::pmr::memory_resource &resource, const mana_move *m);
+
+  protected:
+    /// @brief A copy of m in memory taken from resource, to be
+    /// destroyed with destroy_in().
+    ///
+    /// The size of the move is kept in front of it: moves must not be
+    /// over-aligned.
+    template <typename move_type>
+    static move_type *create_in(std::pmr::memory_resource &resource, const move_type &m);
+
+    /// @brief Room in front of each move made by create_in().
+    static const std::size_t header_size = alignof(std::max_align_t);
 };
 
 template <typename rndgen>
@@ -318,33 +533,59 @@ class swap_elements : public mets::mana_move {
 
     /// @brief Virtual method that applies the move on a point
     gol_type evaluate(const mets::feasible_solution &s) const {
-        const permutation_problem &sol = static_cast<const permutation_problem &>(s);
-        return sol.cost_function() + sol.evaluate_swap(p1, p2);
+        return evaluate(static_cast<const permutation_problem &>(s));
     }
 
-    /// @brief Virtual method that applies the move on a point
-    void apply(mets::feasible_solution &s) const {
-        permutation_problem &sol = static_cast<permutation_problem &>(s);
-        sol.apply_swap(p1, p2);
+    /// @brief Statically typed (non virtual) version of evaluate().
+    gol_type evaluate(const permutation_problem &sol) const {
+        return sol.cost_function() + sol.swap_delta(p1, p2);
     }
 
+    /// @brief Virtual method that applies the move on a point
+    void apply(mets::feasible_solution &s) const { apply(static_cast<permutation_problem &>(s)); }
+
+    /// @brief Statically typed (non virtual) version of apply().
+    void apply(permutation_problem &sol) const { sol.apply_swap(p1, p2); }
+
     /// @brief Clones this move (so that the tabu list can store it)
     clonable *clone() const { return new swap_elements(p1, p2); }
 
+    /// @brief Clones this move in the pool of the tabu list.
+    ///
+    /// Returns 0 for the derived moves, which may override
+    /// opposite_of() or clone(): copying them as a swap_elements would
+    /// slice them.
+    mana_move *opposite_in(std::pmr::memory_resource &resource) const {
+        if (typeid(*this) != typeid(swap_elements)) return 0;
+        return create_in(resource, *this);
+    }
+
     /// @brief An hash function used by the tabu list (the hash value is
     /// used to insert the move in an hash set).
-    size_t hash() const { return (p1) << 16 ^ (p2); }
+    size_t hash() const { return static_cast<size_t>(swap_elements::key().hash()); }
+
+    /// @brief The key of this move (for mets::flat_tabu_list).
+    move_key key() const { return move_key::pair(1, p1, p2); }
 
     /// @brief Comparison operator used to tell if this move is equal to
     /// a move in the simple tabu list move set.
     bool operator==(const mets::mana_move &o) const;
 
+    /// @brief Statically typed (non virtual) comparison operator.
+    bool operator==(const swap_elements &o) const { return p1 == o.p1 && p2 == o.p2; }
+
     /// @brief Modify this swap move.
     void change(int from, int to) {
         p1 = std::min(from, to);
         p2 = std::max(from, to);
     }
 
+    /// @brief The smaller of the two swapped positions.
+    int first() const { return p1; }
+
+    /// @brief The greater of the two swapped positions.
+    int second() const { return p2; }
+
   protected:
     int p1;  ///< the first element to swap
     int p2;  ///< the second element to swap
@@ -364,26 +605,56 @@ class invert_subsequence : public mets::mana_move {
     invert_subsequence(int from, int to) : p1(from), p2(to) {}
 
     /// @brief Virtual method that applies the move on a point
-    gol_type evaluate(const mets::feasible_solution &s) const;
+    gol_type evaluate(const mets::feasible_solution &s) const {
+        return evaluate(static_cast<const permutation_problem &>(s));
+    }
+
+    /// @brief Statically typed (non virtual) version of evaluate().
+    gol_type evaluate(const permutation_problem &sol) const;
 
     /// @brief Virtual method that applies the move on a point
-    void apply(mets::feasible_solution &s) const;
+    void apply(mets::feasible_solution &s) const { apply(static_cast<permutation_problem &>(s)); }
+
+    /// @brief Statically typed (non virtual) version of apply().
+    void apply(permutation_problem &sol) const;
 
     clonable *clone() const { return new invert_subsequence(p1, p2); }
 
+    /// @brief Clones this move in the pool of the tabu list.
+    ///
+    /// Returns 0 for the derived moves, which may override
+    /// opposite_of() or clone(): copying them as a invert_subsequence would
+    /// slice them.
+    mana_move *opposite_in(std::pmr::memory_resource &resource) const {
+        if (typeid(*this) != typeid(invert_subsequence)) return 0;
+        return create_in(resource, *this);
+    }
+
     /// @brief An hash function used by the tabu list (the hash value is
     /// used to insert the move in an hash set).
-    size_t hash() const { return (p1) << 16 ^ (p2); }
+    size_t hash() const { return static_cast<size_t>(invert_subsequence::key().hash()); }
+
+    /// @brief The key of this move (for mets::flat_tabu_list).
+    move_key key() const { return move_key::pair(2, p1, p2); }
 
     /// @brief Comparison operator used to tell if this move is equal to
     /// a move in the tabu list.
     bool operator==(const mets::mana_move &o) const;
 
+    /// @brief Statically typed (non virtual) comparison operator.
+    bool operator==(const invert_subsequence &o) const { return p1 == o.p1 && p2 == o.p2; }
+
     void change(int from, int to) {
         p1 = from;
         p2 = to;
     }
 
+    /// @brief The first position of the inverted subsequence.
+    int first() const { return p1; }
+
+    /// @brief The last position of the inverted subsequence.
+    int second() const { return p2; }
+
   protected:
     int p1;  ///< the first element to swap
     int p2;  ///< the second element to swap
@@ -506,7 +777,8 @@ void mets::swap_neighborhood<random_generator>::refresh(const mets::feasible_sol
 
     // the first n are simple qap_moveS
     for (unsigned int cnt = 0; cnt != n; ++cnt) {
-        const swap_elements *m = static_cast<const swap_elements *>(*ii);
+        // the moves are owned by this neighborhood
+        swap_elements *m = const_cast<swap_elements *>(static_cast<const swap_elements *>(*ii));
         randomize_move(*m, sol.size());
         ++ii;
     }
@@ -515,9 +787,16 @@ void mets::swap_neighborhood<random_generator>::refresh(const mets::feasible_sol
 template <typename random_generator>
 void mets::swap_neighborhood<random_generator>::randomize_move(swap_elements &m,
                                                                unsigned int size) {
+#if defined(METSLIB_HAVE_UNORDERED_MAP) && !defined(METSLIB_TR1_MIXED_NAMESPACE)
+    typedef std::uniform_int_distribution<>::param_type range;
+    int p1 = int_range(rng, range(0, size - 1));
+    int p2 = int_range(rng, range(0, size - 1));
+    while (p1 == p2) p2 = int_range(rng, range(0, size - 1));
+#else
     int p1 = int_range(rng, size);
     int p2 = int_range(rng, size);
     while (p1 == p2) p2 = int_range(rng, size);
+#endif
     // we are friend, so we know how to handle the nuts&bolts of
     // swap_elements
     m.p1 = std::min(p1, p2);
@@ -565,6 +844,328 @@ class invert_full_neighborhood : public mets::move_manager {
     void refresh(const mets::feasible_solution &s) {}
 };
 
+/// @brief Enumeration order of the mets::swap_elements moves of a
+/// permutation problem: (0,1), (0,2), ..., (0,n-1), (1,2), ...
+///
+/// This is the order of the mets::swap_full_neighborhood.
+class swap_move_order {
+  public:
+    /// @brief The order of the swaps of a problem of the given size.
+    explicit swap_move_order(int size) : n_m(size) {}
+
+    /// @brief Number of moves.
+    size_t size() const { return size_t(n_m) * (n_m - 1) / 2; }
+
+    /// @brief Positions of the k-th move.
+    void at(size_t k, int &p1, int &p2) const {
+        double b = 2.0 * n_m - 1.0;
+        p1 = int((b - std::sqrt(b * b - 8.0 * k)) / 2.0);
+        // fix rounding errors
+        while (p1 > 0 && offset(p1) > k) --p1;
+        while (offset(p1 + 1) <= k) ++p1;
+        p2 = int(k - offset(p1)) + p1 + 1;
+    }
+
+    /// @brief Positions of the k-th move, (p1, p2) being the
+    /// positions of the previous one.
+    void next(size_t k, int &p1, int &p2) const {
+        if (++p2 == n_m) {
+            ++p1;
+            p2 = p1 + 1;
+        }
+    }
+
+  protected:
+    /// @brief Index of the first move swapping p1.
+    size_t offset(int p1) const { return size_t(p1) * (2 * n_m - p1 - 1) / 2; }
+
+    int n_m;
+};
+
+/// @brief Enumeration order of the mets::invert_subsequence moves of
+/// a permutation problem: (0,1), (0,2), ..., (0,n-1), (1,0), (1,2), ...
+///
+/// This is the order of the mets::invert_full_neighborhood.
+class invert_move_order {
+  public:
+    /// @brief The order of the inversions of a problem of the given size.
+    explicit invert_move_order(int size) : n_m(size) {}
+
+    /// @brief Number of moves.
+    size_t size() const { return size_t(n_m) * (n_m - 1); }
+
+    /// @brief Positions of the k-th move.
+    void at(size_t k, int &p1, int &p2) const {
+        p1 = int(k / (n_m - 1));
+        p2 = int(k % (n_m - 1));
+        if (p2 >= p1) ++p2;
+    }
+
+    /// @brief Positions of the k-th move, (p1, p2) being the
+    /// positions of the previous one.
+    void next(size_t k, int &p1, int &p2) const {
+        if (++p2 == p1) ++p2;
+        if (p2 == n_m) {
+            ++p1;
+            p2 = (p1 == 0 ? 1 : 0);
+        }
+    }
+
+  protected:
+    int n_m;
+};
+
+/// @brief Enumerates the moves of another order in a pseudo random
+/// order.
+///
+/// The k-th move is the pi(k)-th move of the base order, where pi is
+/// a keyed bijective mix of the indices (multiplications by odd
+/// constants, xor-shifts and xors with the keys) over the smallest
+/// power of two not less than the number of moves, restricted to the
+/// moves by cycle walking (less than two rounds on average). Nothing
+/// is stored and the cost of each move is O(1), a new permutation is
+/// drawn with rekey().
+template <typename order_type>
+class random_move_order {
+  public:
+    /// @brief A random order of the moves of the base order.
+    random_move_order(const order_type &base, unsigned long long seed)
+        : base_m(base), size_m(base.size()), bits_m(1), mask_m(), key1_m(), key2_m() {
+        while (bits_m < 64 && (1ULL << bits_m) < size_m) ++bits_m;
+        mask_m = bits_m == 64 ? ~0ULL : (1ULL << bits_m) - 1;
+        rekey(seed);
+    }
+
+    /// @brief Draws a different permutation.
+    void rekey(unsigned long long seed) {
+        key1_m = mix64(seed) & mask_m;
+        key2_m = mix64(seed + 0x9e3779b97f4a7c15ULL) & mask_m;
+    }
+
+    /// @brief Number of moves.
+    size_t size() const { return size_m; }
+
+    /// @brief Positions of the k-th move.
+    void at(size_t k, int &p1, int &p2) const { base_m.at(permute(k), p1, p2); }
+
+    /// @brief Positions of the k-th move.
+    void next(size_t k, int &p1, int &p2) const {
+        if (k < size_m) at(k, p1, p2);
+    }
+
+    /// @brief Index in the base order of the k-th move.
+    size_t permute(size_t k) const {
+        unsigned long long x = k;
+        do x = round(x);
+        while (x >= size_m);
+        return x;
+    }
+
+  protected:
+    /// @brief One round of the bijection over [0, 2^bits).
+    unsigned long long round(unsigned long long x) const {
+        const unsigned int shift = bits_m / 2 + 1;
+        x = (x ^ key1_m) & mask_m;
+        x = (x * 0x9e3779b97f4a7c15ULL) & mask_m;
+        x ^= x >> shift;
+        x = ((x ^ key2_m) * 0xbf58476d1ce4e5b9ULL) & mask_m;
+        x ^= x >> shift;
+        return x;
+    }
+
+    order_type base_m;
+    size_t size_m;
+    unsigned int bits_m;
+    unsigned long long mask_m;
+    unsigned long long key1_m;
+    unsigned long long key2_m;
+};
+
+/// @brief A random access iterator over the moves of a
+/// mets::implicit_neighborhood.
+///
+/// Moves are not stored anywhere: each iterator owns a single
+/// (flyweight) move that is changed while the iterator moves, and
+/// dereferencing returns a pointer to it. The pointer is only valid
+/// until the iterator is moved or destroyed, this is enough for the
+/// search algorithms that keep the iterator of the best move and not
+/// the pointer.
+template <typename move_type, typename order_type>
+class implicit_move_iterator {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef const move_type *value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const move_type *const *pointer;
+    typedef const move_type *reference;
+
+    /// @brief A singular iterator.
+    implicit_move_iterator() : order_m(0), index_m(0), p1_m(0), p2_m(0), move_m(0, 0) {}
+
+    /// @brief An iterator to the index-th move of the given order.
+    implicit_move_iterator(const order_type &order, size_t index)
+        : order_m(&order), index_m(index), p1_m(0), p2_m(0), move_m(0, 0) {
+        seek();
+    }
+
+    /// @brief The current move.
+    reference operator*() const { return &move_m; }
+
+    implicit_move_iterator &operator++() {
+        ++index_m;
+        order_m->next(index_m, p1_m, p2_m);
+        if (index_m < order_m->size()) move_m.change(p1_m, p2_m);
+        return *this;
+    }
+
+    implicit_move_iterator operator++(int) {
+        implicit_move_iterator tmp(*this);
+        ++*this;
+        return tmp;
+    }
+
+    implicit_move_iterator &operator--() { return *this -= 1; }
+
+    implicit_move_iterator operator--(int) {
+        implicit_move_iterator tmp(*this);
+        --*this;
+        return tmp;
+    }
+
+    implicit_move_iterator &operator+=(difference_type n) {
+        index_m += n;
+        seek();
+        return *this;
+    }
+
+    implicit_move_iterator &operator-=(difference_type n) { return *this += -n; }
+
+    implicit_move_iterator operator+(difference_type n) const {
+        implicit_move_iterator tmp(*this);
+        return tmp += n;
+    }
+
+    implicit_move_iterator operator-(difference_type n) const {
+        implicit_move_iterator tmp(*this);
+        return tmp += -n;
+    }
+
+    difference_type operator-(const implicit_move_iterator &other) const {
+        return difference_type(index_m) - difference_type(other.index_m);
+    }
+
+    bool operator==(const implicit_move_iterator &o) const { return index_m == o.index_m; }
+    bool operator!=(const implicit_move_iterator &o) const { return index_m != o.index_m; }
+    bool operator<(const implicit_move_iterator &o) const { return index_m < o.index_m; }
+    bool operator>(const implicit_move_iterator &o) const { return index_m > o.index_m; }
+    bool operator<=(const implicit_move_iterator &o) const { return index_m <= o.index_m; }
+    bool operator>=(const implicit_move_iterator &o) const { return index_m >= o.index_m; }
+
+    /// @brief Position of the current move in the neighborhood.
+    size_t index() const { return index_m; }
+
+  protected:
+    void seek() {
+        if (index_m < order_m->size()) {
+            order_m->at(index_m, p1_m, p2_m);
+            move_m.change(p1_m, p2_m);
+        }
+    }
+
+    const order_type *order_m;
+    size_t index_m;
+    int p1_m;
+    int p2_m;
+    move_type move_m;
+};
+
+/// @brief A constant neighborhood whose moves are generated on the
+/// fly while it is iterated.
+///
+/// This is a model of the move manager concept (see
+/// mets::move_manager) that does not allocate any move: memory usage
+/// is O(1) and construction is immediate even for huge
+/// neighborhoods. The move_type must be constructible from two
+/// positions and provide a change(p1, p2) method, the order_type
+/// enumerates the positions (see mets::swap_move_order).
+///
+/// @see mets::implicit_move_iterator
+template <typename move_type, typename order_type>
+class implicit_neighborhood {
+  public:
+    /// @brief Iterator type to iterate over moves of the neighborhood
+    typedef implicit_move_iterator<move_type, order_type> iterator;
+
+    /// @brief Size type
+    typedef size_t size_type;
+
+    /// @brief The neighborhood of the moves enumerated by order.
+    explicit implicit_neighborhood(const order_type &order) : order_m(order) {}
+
+    /// @brief Begin iterator of the neighborhood.
+    iterator begin() const { return iterator(order_m, 0); }
+
+    /// @brief End iterator of the neighborhood.
+    iterator end() const { return iterator(order_m, order_m.size()); }
+
+    /// @brief Size of the neighborhood.
+    size_type size() const { return order_m.size(); }
+
+    /// @brief This is a static neighborhood
+    void refresh(const mets::feasible_solution &s) {}
+
+  protected:
+    order_type order_m;
+};
+
+/// @brief The full swap neighborhood, generated on the fly.
+///
+/// Same moves, in the same order, of the mets::swap_full_neighborhood.
+class implicit_swap_neighborhood : public implicit_neighborhood<swap_elements, swap_move_order> {
+  public:
+    /// @param size the size of the problem
+    explicit implicit_swap_neighborhood(int size)
+        : implicit_neighborhood<swap_elements, swap_move_order>(swap_move_order(size)) {}
+};
+
+/// @brief The full swap neighborhood, generated on the fly in a
+/// different random order at each refresh().
+///
+/// Useful for mets::simulated_annealing, that accepts the first good
+/// move: moves are sampled uniformly (without repetitions) at O(1)
+/// cost each, instead of favouring the first moves of the
+/// neighborhood.
+///
+/// @see mets::random_move_order
+class random_swap_neighborhood
+    : public implicit_neighborhood<swap_elements, random_move_order<swap_move_order> > {
+  public:
+    /// @param size the size of the problem
+    /// @param seed the seed of the random orders
+    explicit random_swap_neighborhood(int size, unsigned long long seed = 0)
+        : implicit_neighborhood<swap_elements, random_move_order<swap_move_order> >(
+                  random_move_order<swap_move_order>(swap_move_order(size), seed)),
+          seed_m(seed) {}
+
+    /// @brief Draws a new order of the moves.
+    void refresh(const mets::feasible_solution &s) { order_m.rekey(++seed_m); }
+
+  protected:
+    unsigned long long seed_m;
+};
+
+/// @brief The full subsequence inversion neighborhood, generated on
+/// the fly.
+///
+/// Same moves, in the same order, of the mets::invert_full_neighborhood.
+class implicit_invert_neighborhood
+    : public implicit_neighborhood<invert_subsequence, invert_move_order> {
+  public:
+    /// @param size the size of the problem
+    explicit implicit_invert_neighborhood(int size)
+        : implicit_neighborhood<invert_subsequence, invert_move_order>(invert_move_order(size)) {}
+};
+
 /// @}
 
 /// @brief Functor class to allow hash_set of moves (used by tabu list)
@@ -586,22 +1187,67 @@ inline void mets::permutation_problem::copy_from(const mets::copyable &other) {
     const mets::permutation_problem &o = dynamic_cast<const mets::permutation_problem &>(other);
     pi_m = o.pi_m;
     cost_m = o.cost_m;
+    if (delta_cache_m) {
+        if (o.delta_cache_m)
+            delta_m = o.delta_m;
+        else
+            refresh_delta_cache();
+    }
+    if (hash_enabled_m) hash_m = o.hash_enabled_m ? o.hash_m : compute_hash();
+}
+
+inline void mets::permutation_problem::refresh_delta_cache() {
+    int n = size();
+    delta_m.resize(size_t(n) * (n - 1) / 2);
+    std::vector<gol_type>::iterator delta = delta_m.begin();
+    for (int jj = 1; jj < n; ++jj)
+        for (int ii = 0; ii != jj; ++ii) *delta++ = evaluate_swap(ii, jj);
+}
+
+inline void mets::permutation_problem::update_delta_cache(int r, int s) {
+    int n = size();
+    std::vector<gol_type>::iterator delta = delta_m.begin();
+    for (int jj = 1; jj < n; ++jj) {
+        bool touched = (jj == r || jj == s);
+        for (int ii = 0; ii != jj; ++ii, ++delta) {
+            if (touched || ii == r || ii == s)
+                *delta = evaluate_swap(ii, jj);
+            else
+                *delta = update_delta(ii, jj, r, s, *delta);
+        }
+    }
 }
 
 //________________________________________________________________________
-inline bool mets::swap_elements::operator==(const mets::mana_move &o) const {
+template <typename move_type>
+move_type *mets::mana_move::create_in(std::pmr::memory_resource &resource, const move_type &m) {
+    const std::size_t size = header_size + sizeof(move_type);
+    char *p = static_cast<char *>(resource.allocate(size, alignof(std::max_align_t)));
+    *reinterpret_cast<std::size_t *>(p) = size;
     try {
-        const mets::swap_elements &other = dynamic_cast<const mets::swap_elements &>(o);
-        return (this->p1 == other.p1 && this->p2 == other.p2);
-    } catch (std::bad_cast &e) {
-        return false;
+        return ::new (p + header_size) move_type(m);
+    } catch (...) {
+        resource.deallocate(p, size, alignof(std::max_align_t));
+        throw;
     }
 }
 
+inline void mets::mana_move::destroy_in(std::pmr::memory_resource &resource, const mana_move *m) {
+    if (!m) return;
+    char *p = reinterpret_cast<char *>(const_cast<mana_move *>(m)) - header_size;
+    const std::size_t size = *reinterpret_cast<std::size_t *>(p);
+    m->~mana_move();
+    resource.deallocate(p, size, alignof(std::max_align_t));
+}
+
+inline bool mets::swap_elements::operator==(const mets::mana_move &o) const {
+    const mets::swap_elements *other = dynamic_cast<const mets::swap_elements *>(&o);
+    return other && *this == *other;
+}
+
 //________________________________________________________________________
 
-inline void mets::invert_subsequence::apply(mets::feasible_solution &s) const {
-    mets::permutation_problem &sol = static_cast<mets::permutation_problem &>(s);
+inline void mets::invert_subsequence::apply(mets::permutation_problem &sol) const {
     int size = sol.size();
     int top = p1 < p2 ? (p2 - p1 + 1) : (size + p2 - p1 + 1);
     for (int ii(0); ii != top / 2; ++ii) {
@@ -613,8 +1259,8 @@ inline void mets::invert_subsequence::apply(mets::feasible_solution &s) const {
     }
 }
 
-inline mets::gol_type mets::invert_subsequence::evaluate(const mets::feasible_solution &s) const {
-    const mets::permutation_problem &sol = static_cast<const mets::permutation_problem &>(s);
+inline mets::gol_type mets::invert_subsequence::evaluate(
+        const mets::permutation_problem &sol) const {
     int size = sol.size();
     int top = p1 < p2 ? (p2 - p1 + 1) : (size + p2 - p1 + 1);
     mets::gol_type eval = 0.0;
@@ -623,18 +1269,14 @@ inline mets::gol_type mets::invert_subsequence::evaluate(const mets::feasible_so
         int to = (size + p2 - ii) % size;
         assert(from >= 0 && from < size);
         assert(to >= 0 && to < size);
-        eval += sol.evaluate_swap(from, to);
+        eval += sol.swap_delta(from, to);
     }
     return eval;
 }
 
 inline bool mets::invert_subsequence::operator==(const mets::mana_move &o) const {
-    try {
-        const mets::invert_subsequence &other = dynamic_cast<const mets::invert_subsequence &>(o);
-        return (this->p1 == other.p1 && this->p2 == other.p2);
-    } catch (std::bad_cast &e) {
-        return false;
-    }
+    const mets::invert_subsequence *other = dynamic_cast<const mets::invert_subsequence *>(&o);
+    return other && *this == *other;
 }
 
 #endif
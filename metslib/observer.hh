@@ -25,6 +25,8 @@
 #define METS_OBSERVER_HH_
 
 #include <set>
+#include <vector>
+#include <utility>
 #include <algorithm>
 
 namespace mets {
@@ -63,18 +65,36 @@ class update_observer {
 /// from every method that changes the subject status.
 ///
 ///  Only attached observers (cfr. attach() and detach() methods)
-///  will be notified.
+///  will be notified, in the order they were attached.
+///
+///  Each observer is attached with a mask of the events it is
+///  interested in (the meaning of the bits is up to the subject):
+///  notify_events() only updates the observers subscribed to the
+///  notified events, and observed() tells, with a single test, if
+///  anybody is interested at all.
+///
+///  Observers must not be attached or detached during a
+///  notification.
 ///
 template <typename observed_subject>
 class subject {
   public:
     virtual ~subject(){};
-    /// @brief Attach a new observer to this subject.
+    /// @brief Attach a new observer to this subject, subscribed to
+    ///        all the events.
     ///
     /// @param o: a new observer for this subject.
     ///           if the observer was already present
-    ///           nothing happens.
-    virtual void attach(observer<observed_subject> &o);
+    ///           it is subscribed to all the events.
+    virtual void attach(observer<observed_subject> &o) { attach(o, ~0u); }
+    /// @brief Attach a new observer to this subject, subscribed to
+    ///        some events.
+    ///
+    /// @param o: a new observer for this subject.
+    ///           if the observer was already present
+    ///           its subscription is replaced.
+    /// @param events: the mask of the events to subscribe to.
+    virtual void attach(observer<observed_subject> &o, unsigned int events);
     /// @brief Detach a new observer to this subject.
     ///
     /// @param o: observer to detach from this subject.
@@ -88,10 +108,17 @@ class subject {
     /// and "this" subject is passed as a param.
     ///
     virtual void notify();
+    /// @brief Notify the observers subscribed to some of the events.
+    void notify_events(unsigned int events);
+    /// @brief True if some observer is subscribed to some of the
+    ///        events.
+    bool observed(unsigned int events) const { return (events_m & events) != 0; }
 
   protected:
     subject();
-    std::set<observer<observed_subject> *> observers_m;
+    typedef std::vector<std::pair<observer<observed_subject> *, unsigned int> > observer_list;
+    observer_list observers_m;
+    unsigned int events_m;  ///< the union of the subscriptions
 };
 
 ///
@@ -122,26 +149,64 @@ class observer {
 // Implementation of the template methods in STL
 
 template <typename observed_subject>
-subject<observed_subject>::subject() : observers_m() {}
+subject<observed_subject>::subject() : observers_m(), events_m(0) {}
 
 template <typename observed_subject>
-void subject<observed_subject>::attach(observer<observed_subject> &o) {
-    observers_m.insert(&o);
+void subject<observed_subject>::attach(observer<observed_subject> &o, unsigned int events) {
+    typename observer_list::iterator it = observers_m.begin();
+    while (it != observers_m.end() && it->first != &o) ++it;
+    if (it == observers_m.end())
+        observers_m.push_back(std::make_pair(&o, events));
+    else
+        it->second = events;
+    events_m = 0;
+    for (it = observers_m.begin(); it != observers_m.end(); ++it) events_m |= it->second;
 }
 
 template <typename observed_subject>
 void subject<observed_subject>::detach(observer<observed_subject> &o) {
-    observers_m.erase(&o);
+    events_m = 0;
+    for (typename observer_list::iterator it = observers_m.begin(); it != observers_m.end();) {
+        if (it->first == &o) {
+            it = observers_m.erase(it);
+        } else {
+            events_m |= it->second;
+            ++it;
+        }
+    }
 }
 
 template <typename observed_subject>
 void subject<observed_subject>::notify() {
     // upcast the object to the real observer_subject type
     observed_subject *real_subject = static_cast<observed_subject *>(this);
-    std::for_each(observers_m.begin(), observers_m.end(),
-                  update_observer<observed_subject>(real_subject));
+    update_observer<observed_subject> update(real_subject);
+    for (typename observer_list::iterator it = observers_m.begin(); it != observers_m.end(); ++it)
+        update(it->first);
+}
+
+template <typename observed_subject>
+void subject<observed_subject>::notify_events(unsigned int events) {
+    if (!observed(events)) return;
+    observed_subject *real_subject = static_cast<observed_subject *>(this);
+    update_observer<observed_subject> update(real_subject);
+    for (typename observer_list::iterator it = observers_m.begin(); it != observers_m.end(); ++it)
+        if (it->second & events) update(it->first);
 }
 
+/// @brief Observer policy of the search algorithms: the attached
+/// observers are notified.
+struct attached_observers {
+    static const bool enabled = true;
+};
+
+/// @brief Observer policy of the search algorithms: the
+/// notifications are compiled out, attached observers are never
+/// updated.
+struct null_observer {
+    static const bool enabled = false;
+};
+
 }  // namespace mets
 
 #endif  // METS_OBSERVER_HH_
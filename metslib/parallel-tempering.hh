@@ -0,0 +1,275 @@
+// METSlib source file - parallel-tempering.hh                   -*- C++ -*-
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_PARALLEL_TEMPERING_HH_
+#define METS_PARALLEL_TEMPERING_HH_
+
+#include <mutex>
+
+namespace mets {
+
+/// @addtogroup simulated_annealing
+/// @{
+
+/// @brief Search by parallel tempering (replica exchange Monte
+/// Carlo).
+///
+/// Many replicas of the problem (each one with its own working
+/// solution and move manager) are annealed at the fixed temperatures
+/// of a geometric ladder, running in parallel on a
+/// mets::thread_pool. Each round every replica makes the given
+/// number of Metropolis steps at its temperature (a step is made as
+/// in mets::simulated_annealing: the first move accepted in the
+/// neighborhood is applied), then the replicas at neighbouring
+/// temperatures exchange their temperatures with the Metropolis
+/// criterion, alternating even and odd pairs at each round.
+///
+/// Every solution visited by a replica improving over the best one
+/// is given to the solution recorder. Each replica has its own
+/// random number generator, so that the search is reproducible
+/// whatever the number of threads.
+template <typename move_manager_type>
+class parallel_tempering {
+  public:
+    /// @brief Creates a parallel tempering search.
+    ///
+    /// @param recorder A solution recorder used to record the best
+    /// solution found by the replicas.
+    ///
+    /// @param tc The termination criteria, checked at the end of each
+    /// round with the solution at the lowest temperature.
+    ///
+    /// @param pool The threads running the replicas.
+    ///
+    /// @param min_temp The lowest temperature of the ladder.
+    ///
+    /// @param max_temp The highest temperature of the ladder.
+    ///
+    /// @param steps The Metropolis steps of each replica between two
+    /// exchanges.
+    ///
+    /// @param K The "Boltzmann" constant that we want ot use.
+    ///
+    /// @param seed The seed of the random number generators.
+    parallel_tempering(solution_recorder &recorder, termination_criteria_chain &tc,
+                       thread_pool &pool, double min_temp, double max_temp,
+                       unsigned int steps = 1, double K = 1.0, unsigned long seed = 0);
+
+    /// purposely not implemented (see Effective C++)
+    parallel_tempering(const parallel_tempering &);
+    /// purposely not implemented (see Effective C++)
+    parallel_tempering &operator=(const parallel_tempering &);
+
+    /// @brief Adds a replica (at the top of the ladder).
+    ///
+    /// @param working The working solution of the replica (will be
+    /// modified during the search).
+    ///
+    /// @param moveman The neighborhood of the replica (it must not be
+    /// shared with other replicas).
+    void add_replica(evaluable_solution &working, move_manager_type &moveman);
+
+    /// @brief This method starts the search.
+    ///
+    /// Remember that this is a minimization process.
+    void search();
+
+    /// @brief Number of replicas.
+    unsigned int size() const { return replicas_m.size(); }
+
+    /// @brief The temperature of the given step of the ladder (0 is
+    /// the lowest temperature).
+    double temperature(unsigned int slot) const;
+
+    /// @brief The replica at the given step of the ladder.
+    const evaluable_solution &replica(unsigned int slot) const {
+        return *replicas_m[ladder_m[slot]].working_m;
+    }
+
+    /// @brief Fraction of the accepted exchanges between the given
+    /// step of the ladder and the next one.
+    double exchange_rate(unsigned int slot) const {
+        return attempts_m[slot] ? double(exchanges_m[slot]) / attempts_m[slot] : 0.0;
+    }
+
+    /// @brief Sets the token checked at the end of each round.
+    void cancellation(const cancellation_token &token) { cancellation_m = token; }
+
+  protected:
+    /// @brief The state of one replica.
+    struct replica_state {
+        replica_state(evaluable_solution &working, move_manager_type &moveman,
+                      unsigned long seed, unsigned int index)
+            : working_m(&working), moves_m(&moveman), temp_m(), rng(), ureal(0.0, 1.0) {
+            std::seed_seq sequence = {seed, static_cast<unsigned long>(index)};
+            rng.seed(sequence);
+        }
+        evaluable_solution *working_m;
+        move_manager_type *moves_m;
+        double temp_m;
+        std::mt19937 rng;
+        std::uniform_real_distribution<double> ureal;
+    };
+
+    /// @brief The round of one replica.
+    class replica_steps {
+      public:
+        explicit replica_steps(parallel_tempering &search) : search_m(search) {}
+        void operator()(unsigned int replica) { search_m.steps(search_m.replicas_m[replica]); }
+
+      protected:
+        parallel_tempering &search_m;
+    };
+
+    /// @brief Makes the Metropolis steps of one replica.
+    void steps(replica_state &replica);
+
+    /// @brief Gives the solution to the recorder if it improves.
+    void record(const evaluable_solution &sol);
+
+    /// @brief Attempts the exchanges between the neighbouring
+    /// temperatures, starting from the first (0) or the second (1)
+    /// step of the ladder.
+    void exchange(unsigned int first);
+
+    solution_recorder &recorder_m;
+    termination_criteria_chain &termination_criteria_m;
+    thread_pool &pool_m;
+    double min_temp_m;
+    double max_temp_m;
+    unsigned int steps_m;
+    double K_m;
+    unsigned long seed_m;
+    std::deque<replica_state> replicas_m;
+    std::vector<unsigned int> ladder_m;
+    std::vector<unsigned long> attempts_m;
+    std::vector<unsigned long> exchanges_m;
+    std::mt19937 rng;
+    std::uniform_real_distribution<double> ureal;
+    std::mutex recorder_mutex_m;
+    std::atomic<gol_type> best_cost_m;
+    cancellation_token cancellation_m;
+};
+
+/// @}
+
+}  // namespace mets
+
+template <typename move_manager_t>
+mets::parallel_tempering<move_manager_t>::parallel_tempering(
+        solution_recorder &recorder, termination_criteria_chain &tc, thread_pool &pool,
+        double min_temp, double max_temp, unsigned int steps, double K, unsigned long seed)
+    : recorder_m(recorder),
+      termination_criteria_m(tc),
+      pool_m(pool),
+      min_temp_m(min_temp),
+      max_temp_m(max_temp),
+      steps_m(steps),
+      K_m(K),
+      seed_m(seed),
+      replicas_m(),
+      ladder_m(),
+      attempts_m(),
+      exchanges_m(),
+      rng(seed),
+      ureal(0.0, 1.0),
+      recorder_mutex_m(),
+      best_cost_m(),
+      cancellation_m() {
+    if (min_temp <= 0 || max_temp < min_temp)
+        throw std::runtime_error("temperatures must be 0 < min_temp <= max_temp");
+}
+
+template <typename move_manager_t>
+void mets::parallel_tempering<move_manager_t>::add_replica(evaluable_solution &working,
+                                                           move_manager_t &moveman) {
+    replicas_m.emplace_back(working, moveman, seed_m, replicas_m.size());
+    ladder_m.push_back(ladder_m.size());
+    attempts_m.push_back(0);
+    exchanges_m.push_back(0);
+}
+
+template <typename move_manager_t>
+double mets::parallel_tempering<move_manager_t>::temperature(unsigned int slot) const {
+    if (replicas_m.size() < 2) return min_temp_m;
+    return min_temp_m * std::pow(max_temp_m / min_temp_m, double(slot) / (replicas_m.size() - 1));
+}
+
+template <typename move_manager_t>
+void mets::parallel_tempering<move_manager_t>::search() {
+    if (replicas_m.empty()) return;
+    best_cost_m.store(recorder_m.best_cost());
+    for (unsigned int slot = 0; slot != ladder_m.size(); ++slot)
+        replicas_m[ladder_m[slot]].temp_m = temperature(slot);
+    for (unsigned int ii = 0; ii != replicas_m.size(); ++ii) record(*replicas_m[ii].working_m);
+
+    replica_steps task(*this);
+    unsigned int round = 0;
+    while (!cancellation_m.stop_requested() &&
+           !termination_criteria_m(*replicas_m[ladder_m[0]].working_m)) {
+        pool_m.run(replicas_m.size(), task);
+        exchange(round++ % 2);
+    }
+}
+
+template <typename move_manager_t>
+void mets::parallel_tempering<move_manager_t>::steps(replica_state &replica) {
+    evaluable_solution &working = *replica.working_m;
+    move_manager_t &moves = *replica.moves_m;
+    for (unsigned int step = 0; step != steps_m; ++step) {
+        gol_type actual_cost = working.cost_function();
+        moves.refresh(working);
+        for (typename move_manager_t::iterator movit = moves.begin(); movit != moves.end();
+             ++movit) {
+            gol_type cost = (*movit)->evaluate(working);
+            double delta = ((double)(cost - actual_cost));
+            if (delta < 0 ||
+                replica.ureal(replica.rng) < exp(-delta / (K_m * replica.temp_m))) {
+                (*movit)->apply(working);
+                if (cost < best_cost_m.load(std::memory_order_relaxed)) record(working);
+                break;
+            }
+        }
+    }
+}
+
+template <typename move_manager_t>
+void mets::parallel_tempering<move_manager_t>::record(const evaluable_solution &sol) {
+    std::lock_guard<std::mutex> lock(recorder_mutex_m);
+    if (recorder_m.accept(sol)) best_cost_m.store(recorder_m.best_cost());
+}
+
+template <typename move_manager_t>
+void mets::parallel_tempering<move_manager_t>::exchange(unsigned int first) {
+    for (unsigned int slot = first; slot + 1 < ladder_m.size(); slot += 2) {
+        replica_state &cold = replicas_m[ladder_m[slot]];
+        replica_state &hot = replicas_m[ladder_m[slot + 1]];
+        // accept with probability min(1, exp((b_cold - b_hot)(E_cold - E_hot)))
+        double delta = (1.0 / (K_m * cold.temp_m) - 1.0 / (K_m * hot.temp_m)) *
+                       (cold.working_m->cost_function() - hot.working_m->cost_function());
+        ++attempts_m[slot];
+        if (delta >= 0 || ureal(rng) < exp(delta)) {
+            std::swap(cold.temp_m, hot.temp_m);
+            std::swap(ladder_m[slot], ladder_m[slot + 1]);
+            ++exchanges_m[slot];
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,221 @@
+// METSlib source file - profiler.hh                             -*- C++ -*-
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_PROFILER_HH_
+#define METS_PROFILER_HH_
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#if defined(__linux__)
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+namespace mets {
+
+/// @addtogroup common
+/// @{
+
+/// @brief Measures the phases of a search with the hardware
+/// performance counters.
+///
+/// Set it as the profiler of a search (see
+/// mets::abstract_search::profiler()): for each phase (refresh,
+/// evaluate, apply, see mets::phase_listener) it accumulates the
+/// number of calls, the elapsed time and, on Linux, the CPU cycles,
+/// the instructions, the last level cache misses and the branch
+/// misses counted by perf_event_open(2).
+///
+/// The counters that cannot be opened (no kernel support, no
+/// hardware, or a restrictive /proc/sys/kernel/perf_event_paranoid)
+/// are left out: without any of them the profiler measures the time
+/// only (see available()). The phases whose counters could not be
+/// read are counted apart and left out of the event totals.
+///
+/// Only the thread running the search is counted, in user space:
+/// the workers of the parallel searches are not. Reading the counters
+/// costs a system call at each phase boundary.
+class perf_profiler : public phase_listener {
+  public:
+    enum event {
+        CYCLES = 0,
+        INSTRUCTIONS,
+        /// @brief Last level cache misses.
+        CACHE_MISSES,
+        BRANCH_MISSES,
+        EVENTS
+    };
+
+    /// @brief What was measured in a phase.
+    struct phase_counters {
+        unsigned long calls;
+        /// @brief The calls whose events could not be read (their
+        /// time is measured all the same).
+        unsigned long unread;
+        unsigned long long time_ns;
+        /// @brief The hardware events (0 if not available).
+        unsigned long long events[EVENTS];
+    };
+
+    /// @brief Opens the counters.
+    ///
+    /// @param hardware False to measure the time only.
+    explicit perf_profiler(bool hardware = true);
+
+    /// purposely not implemented (see Effective C++)
+    perf_profiler(const perf_profiler &);
+    /// purposely not implemented (see Effective C++)
+    perf_profiler &operator=(const perf_profiler &);
+
+    /// @brief Closes the counters.
+    ~perf_profiler();
+
+    /// @brief True if the event is counted.
+    bool available(int e) const { return fd_m[e] >= 0; }
+
+    /// @brief True if any hardware event is counted.
+    bool available() const { return opened_m != 0; }
+
+    void phase_begin(int phase);
+
+    void phase_end(int phase);
+
+    /// @brief What was measured in a phase.
+    const phase_counters &counters(int phase) const { return phases_m[phase]; }
+
+    /// @brief Clears the measures.
+    void reset() { std::memset(phases_m, 0, sizeof(phases_m)); }
+
+    /// @brief Prints a line per phase (time, then the available
+    /// events).
+    void print(std::ostream &os) const;
+
+  protected:
+    /// @brief Reads the time and the events.
+    ///
+    /// @return False if the events could not be read (they are left
+    /// at 0).
+    bool sample(unsigned long long *values) const;
+
+    int fd_m[EVENTS];
+    /// @brief The opened events, in the order of the group.
+    int order_m[EVENTS];
+    int opened_m;
+    unsigned long long start_m[PHASES][1 + EVENTS];
+    /// @brief True if the events at the start of the phase were read.
+    bool start_read_m[PHASES];
+    phase_counters phases_m[PHASES];
+};
+
+/// @}
+}  // namespace mets
+
+inline mets::perf_profiler::perf_profiler(bool hardware) : opened_m(0) {
+    for (int e = 0; e != EVENTS; ++e) fd_m[e] = order_m[e] = -1;
+    std::memset(start_m, 0, sizeof(start_m));
+    for (int p = 0; p != PHASES; ++p) start_read_m[p] = false;
+    reset();
+#if defined(__linux__)
+    if (!hardware) return;
+    static const std::uint64_t configs[EVENTS] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES};
+    int leader = -1;
+    for (int e = 0; e != EVENTS; ++e) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[e];
+        attr.read_format = PERF_FORMAT_GROUP;
+        attr.disabled = leader < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_m[e] = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+        if (fd_m[e] < 0) continue;
+        if (leader < 0) leader = fd_m[e];
+        order_m[opened_m++] = e;
+    }
+    if (leader >= 0) ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+    (void)hardware;
+#endif
+}
+
+inline mets::perf_profiler::~perf_profiler() {
+#if defined(__linux__)
+    // the members before the leader
+    for (int e = EVENTS - 1; e >= 0; --e)
+        if (fd_m[e] >= 0) ::close(fd_m[e]);
+#endif
+}
+
+inline bool mets::perf_profiler::sample(unsigned long long *values) const {
+    values[0] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+    for (int e = 0; e != EVENTS; ++e) values[1 + e] = 0;
+#if defined(__linux__)
+    if (!opened_m) return true;
+    // PERF_FORMAT_GROUP: the number of events, then their values
+    std::uint64_t group[1 + EVENTS];
+    const ssize_t size = (1 + opened_m) * sizeof(std::uint64_t);
+    if (::read(fd_m[order_m[0]], group, size) != size) return false;
+    for (int ii = 0; ii != opened_m; ++ii) values[1 + order_m[ii]] = group[1 + ii];
+#endif
+    return true;
+}
+
+inline void mets::perf_profiler::phase_begin(int phase) {
+    start_read_m[phase] = sample(start_m[phase]);
+}
+
+inline void mets::perf_profiler::phase_end(int phase) {
+    unsigned long long end[1 + EVENTS];
+    const bool read = sample(end);
+    phase_counters &c = phases_m[phase];
+    ++c.calls;
+    c.time_ns += end[0] - start_m[phase][0];
+    // a failed read would add a difference with 0
+    if (!read || !start_read_m[phase]) {
+        ++c.unread;
+        return;
+    }
+    for (int e = 0; e != EVENTS; ++e) c.events[e] += end[1 + e] - start_m[phase][1 + e];
+}
+
+inline void mets::perf_profiler::print(std::ostream &os) const {
+    static const char *phases[PHASES] = {"refresh", "evaluate", "apply"};
+    static const char *events[EVENTS] = {"cycles", "instructions", "cache misses",
+                                         "branch misses"};
+    for (int p = 0; p != PHASES; ++p) {
+        os << phases[p] << "\t" << phases_m[p].calls << " calls\t" << phases_m[p].time_ns
+           << " ns";
+        for (int e = 0; e != EVENTS; ++e)
+            if (available(e)) os << "\t" << phases_m[p].events[e] << " " << events[e];
+        if (phases_m[p].unread) os << "\t" << phases_m[p].unread << " unread";
+        os << "\n";
+    }
+}
+
+#endif
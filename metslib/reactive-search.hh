@@ -0,0 +1,250 @@
+// METSlib source file - reactive-search.hh                      -*- C++ -*-
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_REACTIVE_SEARCH_HH_
+#define METS_REACTIVE_SEARCH_HH_
+
+namespace mets {
+
+/// @addtogroup tabu_search
+/// @{
+
+/// @brief Reactive tabu search (Battiti and Tecchiolli): adapts the
+/// tenure of a tabu list to the behaviour of the search.
+///
+/// Attach this listener to a search (e.g. a mets::tabu_search) on a
+/// mets::permutation_problem. After each move the working solution
+/// is looked up, by its 64 bit Zobrist hash (see
+/// mets::permutation_problem::hash()), in a table of the visited
+/// solutions:
+///
+/// - when a solution is visited again the tenure of the tabu list is
+///   increased by 10% (at least by one) and the average length of
+///   the cycles is updated;
+///
+/// - when no solution was repeated for more iterations than the
+///   average cycle length the tenure is decreased by 10%;
+///
+/// - when more than chaos solutions were visited more than
+///   repetitions times (chaotic trapping), the search escapes with a
+///   random walk of swaps, proportional to the average cycle length,
+///   and the table is cleared.
+///
+/// The tenure stays in [min_tenure, max_tenure]. The walk swaps are
+/// made tabu as well. Only the MOVE_MADE step is needed: attach the
+/// listener with <code>search.attach(listener,
+/// search.step_mask(search.MOVE_MADE))</code> to avoid the other
+/// notifications.
+///
+/// The listener enables the incremental hash of the working solution
+/// (mets::permutation_problem::enable_hash()) at the first move, so
+/// the lookups cost O(1) and the hash stays right whatever changes
+/// the solution (e.g. the migrations of a mets::island_search).
+template <typename move_manager_type>
+class reactive_tabu_listener : public search_listener<move_manager_type> {
+  public:
+    typedef abstract_search<move_manager_type> search_type;
+
+    /// @brief Creates the listener.
+    ///
+    /// @param tabus The tabu list whose tenure is adapted.
+    /// @param min_tenure The minimum tenure.
+    /// @param max_tenure The maximum tenure.
+    /// @param seed Seed of the escape walks.
+    /// @param repetitions Number of visits after which a solution
+    /// is considered often repeated.
+    /// @param chaos Number of often repeated solutions that trigger
+    /// an escape.
+    reactive_tabu_listener(tabu_list_chain &tabus, unsigned int min_tenure,
+                           unsigned int max_tenure, unsigned long long seed = 0,
+                           unsigned int repetitions = 3, unsigned int chaos = 3);
+
+    /// @brief Looks up the working solution after each move.
+    void update(search_type *search);
+
+    /// @brief Number of visits to already visited solutions.
+    unsigned long repetitions() const { return repetitions_m; }
+
+    /// @brief Number of escape walks.
+    unsigned long escapes() const { return escapes_m; }
+
+    /// @brief Number of solutions in the visited table.
+    size_t visited() const { return visited_m; }
+
+    /// @brief Average length of the detected cycles.
+    double cycle_length() const { return cycle_m; }
+
+    /// @brief Hash of the last seen working solution.
+    size_t hash() const { return hash_m; }
+
+  protected:
+    /// @brief An entry of the visited table (count is 0 for the free
+    /// entries).
+    struct entry {
+        size_t hash;
+        unsigned long last;
+        unsigned long count;
+    };
+
+    /// @brief The entry of h in the table (free if not found).
+    entry &lookup(size_t h);
+
+    /// @brief Doubles the size of the table.
+    void grow();
+
+    /// @brief Sets the tenure, within the bounds.
+    void tenure(double t);
+
+    /// @brief Reacts to the visit of the current solution.
+    void react(permutation_problem &sol);
+
+    /// @brief The escape random walk.
+    void escape(permutation_problem &sol);
+
+    tabu_list_chain &tabus_m;
+    unsigned int min_tenure_m;
+    unsigned int max_tenure_m;
+    unsigned int repetitions_limit_m;
+    unsigned int chaos_limit_m;
+    double tenure_m;
+    double cycle_m;
+    unsigned long iteration_m;
+    unsigned long last_change_m;
+    unsigned int chaotic_m;
+    unsigned long repetitions_m;
+    unsigned long escapes_m;
+    unsigned long long state_m;
+    size_t hash_m;
+    std::vector<entry> table_m;
+    size_t visited_m;
+};
+
+/// @}
+}  // namespace mets
+
+template <typename move_manager_type>
+mets::reactive_tabu_listener<move_manager_type>::reactive_tabu_listener(
+        tabu_list_chain &tabus, unsigned int min_tenure, unsigned int max_tenure,
+        unsigned long long seed, unsigned int repetitions, unsigned int chaos)
+    : search_listener<move_manager_type>(),
+      tabus_m(tabus),
+      min_tenure_m(std::max(1u, min_tenure)),
+      max_tenure_m(std::max(min_tenure_m, max_tenure)),
+      repetitions_limit_m(repetitions),
+      chaos_limit_m(chaos),
+      tenure_m(tabus.tenure()),
+      cycle_m(1.0),
+      iteration_m(0),
+      last_change_m(0),
+      chaotic_m(0),
+      repetitions_m(0),
+      escapes_m(0),
+      state_m(seed),
+      hash_m(0),
+      table_m(1024, entry()),
+      visited_m(0) {
+    tenure(tenure_m);
+}
+
+template <typename move_manager_type>
+void mets::reactive_tabu_listener<move_manager_type>::update(search_type *search) {
+    if (search->step() != search_type::MOVE_MADE) return;
+    permutation_problem &sol = dynamic_cast<permutation_problem &>(search->working());
+    if (!sol.hash_enabled()) sol.enable_hash();
+    hash_m = sol.hash();
+    ++iteration_m;
+    react(sol);
+}
+
+template <typename move_manager_type>
+typename mets::reactive_tabu_listener<move_manager_type>::entry &
+mets::reactive_tabu_listener<move_manager_type>::lookup(size_t h) {
+    const size_t mask = table_m.size() - 1;
+    size_t ii = static_cast<size_t>(mix64(h)) & mask;
+    while (table_m[ii].count && table_m[ii].hash != h) ii = (ii + 1) & mask;
+    return table_m[ii];
+}
+
+template <typename move_manager_type>
+void mets::reactive_tabu_listener<move_manager_type>::grow() {
+    std::vector<entry> old(2 * table_m.size(), entry());
+    old.swap(table_m);
+    for (size_t ii = 0; ii != old.size(); ++ii)
+        if (old[ii].count) lookup(old[ii].hash) = old[ii];
+}
+
+template <typename move_manager_type>
+void mets::reactive_tabu_listener<move_manager_type>::tenure(double t) {
+    tenure_m = std::min(double(max_tenure_m), std::max(double(min_tenure_m), t));
+    tabus_m.tenure(static_cast<unsigned int>(tenure_m + 0.5));
+}
+
+template <typename move_manager_type>
+void mets::reactive_tabu_listener<move_manager_type>::react(permutation_problem &sol) {
+    if (2 * (visited_m + 1) > table_m.size()) grow();
+    entry &e = lookup(hash_m);
+    if (e.count) {
+        // a cycle: lengthen the tenure
+        const unsigned long length = iteration_m - e.last;
+        e.last = iteration_m;
+        ++repetitions_m;
+        // a solution counts as often repeated once, when it goes past
+        // the limit
+        if (++e.count == repetitions_limit_m + 1 && ++chaotic_m > chaos_limit_m) {
+            escape(sol);
+            return;
+        }
+        cycle_m = 0.1 * length + 0.9 * cycle_m;
+        tenure(std::max(tenure_m * 1.1, tenure_m + 1.0));
+        last_change_m = iteration_m;
+    } else {
+        e.hash = hash_m;
+        e.last = iteration_m;
+        e.count = 1;
+        ++visited_m;
+        // no cycles for a while: shorten the tenure
+        if (iteration_m - last_change_m > cycle_m) {
+            tenure(tenure_m * 0.9);
+            last_change_m = iteration_m;
+        }
+    }
+}
+
+template <typename move_manager_type>
+void mets::reactive_tabu_listener<move_manager_type>::escape(permutation_problem &sol) {
+    const int n = sol.size();
+    const unsigned int steps = 1 + static_cast<unsigned int>((1.0 + cycle_m) / 2);
+    for (unsigned int ii = 0; ii != steps && n > 1; ++ii) {
+        state_m += 0x9e3779b97f4a7c15ULL;
+        const unsigned long long r = mix64(state_m);
+        const int i = static_cast<int>(r % n);
+        const int j = (i + 1 + static_cast<int>((r >> 32) % (n - 1))) % n;
+        swap_elements walk(i, j);
+        tabus_m.tabu(sol, walk);
+        walk.apply(sol);
+    }
+    hash_m = sol.hash();
+    std::fill(table_m.begin(), table_m.end(), entry());
+    visited_m = 0;
+    chaotic_m = 0;
+    last_change_m = iteration_m;
+    ++escapes_m;
+}
+
+#endif
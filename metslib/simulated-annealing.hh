@@ -27,13 +27,36 @@ namespace mets {
 /// @defgroup simulated_annealing Simulated Annealing
 /// @{
 
+/// @brief Statistics of the Markov chain run at one temperature
+/// (for Simulated Annealing).
+///
+/// @see mets::simulated_annealing::chain_length()
+struct chain_statistics {
+    chain_statistics() : temperature(), iterations(), trials(), accepted(), improvements() {}
+
+    /// @brief Fraction of the evaluated moves that were accepted.
+    double acceptance_rate() const { return trials ? double(accepted) / trials : 0.0; }
+
+    /// @brief The temperature of the chain.
+    double temperature;
+    /// @brief Search iterations (walks of the neighborhood).
+    unsigned long iterations;
+    /// @brief Moves evaluated.
+    unsigned long trials;
+    /// @brief Moves accepted.
+    unsigned long accepted;
+    /// @brief Moves improving the best solution found.
+    unsigned long improvements;
+};
+
 /// @brief Cooling criteria (for Simulated Annealing).
 ///
 /// @see mets::simulated_annealing
 ///
 /// An abstract annealing schedule. Implementations
 /// should decide the new temperature every time the
-/// subscript operator is called (every search iteration)
+/// subscript operator is called (at the end of each chain, by
+/// default every search iteration)
 class abstract_cooling_schedule {
   public:
     /// @brief Constructor
@@ -48,13 +71,141 @@ class abstract_cooling_schedule {
     /// @param fs The current working solution.
     /// @return The new scheduled temperature.
     virtual double operator()(double temp, feasible_solution &fs) = 0;
+
+    /// @brief Called with the statistics of the chain that just
+    /// ended, right before operator().
+    ///
+    /// Adaptive schedules (e.g. mets::lam_cooling) can use it, the
+    /// default implementation does nothing.
+    virtual void chain_end(const chain_statistics &stats) {}
+};
+
+/// @brief The Metropolis acceptance criterion (for Simulated
+/// Annealing).
+///
+/// A move changing the cost by delta is accepted if it improves the
+/// solution, otherwise with probability exp(-delta / KT), drawing a
+/// uniform variate for each non improving move.
+///
+/// This is the default acceptance policy of mets::simulated_annealing.
+/// An acceptance policy provides start(), called with the current KT
+/// product before each walk of the neighborhood, an operator() testing
+/// one move and first() testing many evaluated moves at once. The
+/// uniform argument is a function object returning uniform variates
+/// in [0, 1).
+///
+/// @see mets::threshold_acceptance
+class metropolis_acceptance {
+  public:
+    metropolis_acceptance() : kt_m(1.0) {}
+
+    /// @brief Starts a walk of the neighborhood at the given KT.
+    void start(double kt) { kt_m = kt; }
+
+    /// @brief True if a move changing the cost by delta is accepted.
+    template <typename generator>
+    bool operator()(double delta, generator &uniform) {
+        return delta < 0 || uniform() < exp(-delta / kt_m);
+    }
+
+    /// @brief Index of the first accepted move in costs[0, size), or
+    /// size if no move is accepted.
+    ///
+    /// @param costs The costs of the solutions after each move.
+    /// @param size The number of moves.
+    /// @param current The current cost.
+    /// @param uniform The random number generator.
+    template <typename generator>
+    unsigned int first(const gol_type *costs, unsigned int size, gol_type current,
+                       generator &uniform);
+
+  protected:
+    double kt_m;
+};
+
+/// @brief An acceptance criterion without a logarithm or an
+/// exponential per move (for Simulated Annealing).
+///
+/// Instead of drawing a variate u for each move and comparing it
+/// with exp(-delta / KT), the variate is drawn first and turned into
+/// the equivalent cost threshold -KT ln(u), which is then shared by a
+/// batch of consecutive moves: a move is accepted if delta is below
+/// the threshold (improving moves are always accepted). The
+/// comparisons of a batch of evaluated moves are done in blocks that
+/// the compiler can vectorize.
+///
+/// Each single move is accepted with the Metropolis probability, but
+/// the decisions within a batch are correlated: with batch = 1 this
+/// is equivalent to mets::metropolis_acceptance (with a different use
+/// of the random numbers), larger batches trade a bit of randomness
+/// for speed when most moves are rejected.
+class threshold_acceptance {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param batch The number of moves sharing one threshold.
+    explicit threshold_acceptance(unsigned int batch = 16)
+        : batch_m(batch ? batch : 1), kt_m(1.0), threshold_m(), left_m(0) {}
+
+    /// @brief Starts a walk of the neighborhood at the given KT.
+    void start(double kt) {
+        kt_m = kt;
+        left_m = 0;
+    }
+
+    /// @brief True if a move changing the cost by delta is accepted.
+    template <typename generator>
+    bool operator()(double delta, generator &uniform) {
+        if (left_m == 0) draw(uniform);
+        --left_m;
+        return delta < threshold_m;
+    }
+
+    /// @brief Index of the first accepted move in costs[0, size), or
+    /// size if no move is accepted.
+    ///
+    /// @see mets::metropolis_acceptance::first()
+    template <typename generator>
+    unsigned int first(const gol_type *costs, unsigned int size, gol_type current,
+                       generator &uniform);
+
+    /// @brief The number of moves sharing one threshold.
+    unsigned int batch() const { return batch_m; }
+
+  protected:
+    template <typename generator>
+    void draw(generator &uniform) {
+        threshold_m = -kt_m * std::log(uniform());
+        left_m = batch_m;
+    }
+
+    unsigned int batch_m;
+    double kt_m;
+    double threshold_m;
+    unsigned int left_m;
 };
 
 /// @brief Search by Simulated Annealing.
-template <typename move_manager_type>
+///
+/// As for mets::tabu_search the template parameters other than the
+/// move_manager_type can be used (or deduced) to instantiate the
+/// search on the concrete solution and component types, avoiding
+/// virtual calls on the hot path.
+///
+/// The listeners are notified of the ITERATION_BEGIN and
+/// ITERATION_END steps around each iteration (an iteration ends at
+/// the first accepted move), of MOVE_MADE and IMPROVEMENT_MADE as the
+/// moves are made.
+template <typename move_manager_type, typename solution_type = evaluable_solution,
+          typename recorder_type = solution_recorder,
+          typename termination_type = termination_criteria_chain,
+          typename cooling_type = abstract_cooling_schedule,
+          typename acceptance_type = metropolis_acceptance>
 class simulated_annealing : public mets::abstract_search<move_manager_type> {
   public:
-    typedef simulated_annealing<move_manager_type> search_type;
+    typedef simulated_annealing<move_manager_type, solution_type, recorder_type, termination_type,
+                                cooling_type, acceptance_type>
+            search_type;
     /// @brief Creates a search by simulated annealing instance.
     ///
     /// @param working The working solution (this will be modified
@@ -84,14 +235,17 @@ class simulated_annealing : public mets::abstract_search<move_manager_type> {
     /// influence the search quality and duration).
     ///
     /// @param K The "Boltzmann" constant that we want ot use (default is 1).
-    simulated_annealing(evaluable_solution &starting_point, solution_recorder &recorder,
-                        move_manager_type &moveman, termination_criteria_chain &tc,
-                        abstract_cooling_schedule &cs, double starting_temp,
-                        double stop_temp = 1e-7, double K = 1.0);
+    ///
+    /// @param acceptance The acceptance criterion (e.g. a
+    /// mets::threshold_acceptance).
+    simulated_annealing(solution_type &starting_point, recorder_type &recorder,
+                        move_manager_type &moveman, termination_type &tc, cooling_type &cs,
+                        double starting_temp, double stop_temp = 1e-7, double K = 1.0,
+                        const acceptance_type &acceptance = acceptance_type());
 
     /// purposely not implemented (see Effective C++)
-    simulated_annealing(const simulated_annealing &);
-    simulated_annealing &operator=(const simulated_annealing &);
+    simulated_annealing(const search_type &);
+    search_type &operator=(const search_type &);
 
     /// @brief This method starts the simulated annealing search
     /// process.
@@ -108,24 +262,182 @@ class simulated_annealing : public mets::abstract_search<move_manager_type> {
     /// @brief The annealing schedule instance.
     ///
     /// @return The cooling schedule used by this search process.
-    const abstract_cooling_schedule &cooling_schedule() const { return cooling_schedule_m; }
+    const cooling_type &cooling_schedule() const { return cooling_schedule_m; }
+
+    /// @brief Seeds the random number generator (the search is
+    /// reproducible for a given seed).
+    void seed(unsigned long value) { rng.seed(value); }
+
+    /// @brief Sets the length of the Markov chain run at each
+    /// temperature.
+    ///
+    /// The cooling schedule is called when the chain ends: after the
+    /// given number of evaluated moves (e.g. a multiple of the
+    /// neighborhood size) or, if accepted is not zero, as soon as the
+    /// given number of moves was accepted. With both values set to 0
+    /// (the default) the temperature is updated after every
+    /// iteration.
+    ///
+    /// @param trials The evaluated moves of a chain.
+    /// @param accepted The accepted moves of a chain.
+    void chain_length(unsigned long trials, unsigned long accepted = 0) {
+        chain_trials_m = trials;
+        chain_accepted_m = accepted;
+    }
+
+    /// @brief Statistics of the current chain.
+    const chain_statistics &chain() const { return chain_m; }
 
   protected:
-    termination_criteria_chain &termination_criteria_m;
-    abstract_cooling_schedule &cooling_schedule_m;
+    typedef typename move_manager_type::iterator iterator;
+
+    /// @brief Adapts uniform() to a function object for the
+    /// acceptance policy.
+    struct uniform_generator {
+        search_type &search_m;
+        double operator()() { return search_m.uniform(); }
+    };
+
+    /// @brief The acceptance test of a move changing the cost by
+    /// delta.
+    bool accept(double delta) {
+        uniform_generator generator = {*this};
+        return acceptance_m(delta, generator);
+    }
+
+    /// @brief Applies an accepted move, records the solution and
+    /// notifies the listeners.
+    ///
+    /// @param movit The accepted move.
+    /// @param index Its position in the neighborhood scan.
+    /// @param cost The cost of the working solution after the move.
+    /// @param delta The cost change of the move.
+    /// @return True if the move improved the best solution.
+    bool make_move(iterator movit, long index, gol_type cost, gol_type delta);
+
+    /// @brief Accounts an iteration to the current chain and, at
+    /// the end of the chain, updates the temperature.
+    ///
+    /// @param trials The moves evaluated by the iteration.
+    /// @param accepted True if a move was accepted.
+    /// @param improved True if the best solution was improved.
+    void end_iteration(unsigned long trials, bool accepted, bool improved);
+
+    solution_type &working_m;
+    recorder_type &recorder_m;
+    termination_type &termination_criteria_m;
+    cooling_type &cooling_schedule_m;
     double starting_temp_m;
     double stop_temp_m;
     double current_temp_m;
     double K_m;
+    unsigned long chain_trials_m;
+    unsigned long chain_accepted_m;
+    chain_statistics chain_m;
+    acceptance_type acceptance_m;
 #if defined(METSLIB_HAVE_UNORDERED_MAP) && !defined(METSLIB_TR1_MIXED_NAMESPACE)
     std::uniform_real_distribution<double> ureal;
     std::mt19937 rng;
-    decltype(std::bind(ureal, rng)) gen;
 #else
     std::tr1::uniform_real<double> ureal;
     std::tr1::mt19937 rng;
     std::tr1::variate_generator<std::tr1::mt19937, std::tr1::uniform_real<double> > gen;
 #endif
+
+    /// @brief A random number uniformly distributed in [0, 1).
+    double uniform() {
+#if defined(METSLIB_HAVE_UNORDERED_MAP) && !defined(METSLIB_TR1_MIXED_NAMESPACE)
+        return ureal(rng);
+#else
+        return gen();
+#endif
+    }
+};
+
+/// @brief Search by Simulated Annealing evaluating the moves
+/// speculatively on a pool of threads.
+///
+/// The neighborhood is walked in batches: the moves of a batch are
+/// evaluated concurrently on the mets::thread_pool, then the batch is
+/// scanned in order and the first move passing the Metropolis test
+/// is made, as in the serial algorithm. The uniform variates are
+/// drawn during the (cheap) ordered scan, for the non improving moves
+/// only, exactly as the serial search does: for a given seed the
+/// trajectory is the same of mets::simulated_annealing, the moves
+/// following the accepted one in its batch are evaluated and
+/// discarded.
+///
+/// The move_manager_type iterator must be a random access iterator
+/// and move evaluation must be safe to be called concurrently on the
+/// same solution (it is const).
+///
+/// The batch is scanned with the acceptance policy first(), that
+/// can compare many costs at once (see mets::threshold_acceptance).
+///
+template <typename move_manager_type, typename solution_type = evaluable_solution,
+          typename recorder_type = solution_recorder,
+          typename termination_type = termination_criteria_chain,
+          typename cooling_type = abstract_cooling_schedule,
+          typename acceptance_type = metropolis_acceptance>
+class parallel_simulated_annealing
+    : public simulated_annealing<move_manager_type, solution_type, recorder_type,
+                                 termination_type, cooling_type, acceptance_type> {
+  public:
+    typedef parallel_simulated_annealing<move_manager_type, solution_type, recorder_type,
+                                         termination_type, cooling_type, acceptance_type>
+            search_type;
+    typedef simulated_annealing<move_manager_type, solution_type, recorder_type,
+                                termination_type, cooling_type, acceptance_type>
+            annealing_type;
+
+    /// @brief Creates a speculative search by simulated annealing.
+    ///
+    /// Parameters are the same of mets::simulated_annealing, in
+    /// addition:
+    ///
+    /// @param pool The threads used to evaluate the moves.
+    ///
+    /// @param batch The number of moves evaluated concurrently (0
+    /// means 8 moves per thread of the pool).
+    parallel_simulated_annealing(solution_type &starting_point, recorder_type &recorder,
+                                 move_manager_type &moveman, termination_type &tc,
+                                 cooling_type &cs, double starting_temp, thread_pool &pool,
+                                 unsigned int batch = 0, double stop_temp = 1e-7,
+                                 double K = 1.0,
+                                 const acceptance_type &acceptance = acceptance_type());
+
+    /// purposely not implemented (see Effective C++)
+    parallel_simulated_annealing(const search_type &);
+    search_type &operator=(const search_type &);
+
+    /// @brief This method starts the simulated annealing search
+    /// process.
+    void search();
+
+    /// @brief The number of moves evaluated concurrently.
+    unsigned int batch() const { return batch_m; }
+
+  protected:
+    typedef typename move_manager_type::iterator iterator;
+
+    /// @brief Evaluation of one chunk of a batch.
+    class batch_evaluation {
+      public:
+        batch_evaluation(search_type &search, iterator begin, unsigned int size,
+                         unsigned int chunks)
+            : search_m(search), begin_m(begin), size_m(size), chunks_m(chunks) {}
+        void operator()(unsigned int chunk);
+
+      protected:
+        search_type &search_m;
+        iterator begin_m;
+        unsigned int size_m;
+        unsigned int chunks_m;
+    };
+
+    thread_pool &pool_m;
+    unsigned int batch_m;
+    std::vector<gol_type> costs_m;
 };
 
 /// @brief Original ECS proposed by Kirkpatrick
@@ -154,59 +466,560 @@ class linear_cooling : public abstract_cooling_schedule {
     double decrement_m;
 };
 
+/// @brief Adaptive schedule keeping the acceptance rate on the
+/// curve proposed by Lam and Delosme (for Simulated Annealing).
+///
+/// The target acceptance rate depends on the fraction t of the
+/// budget (evaluated moves) spent: it falls from 1 to 0.44 during
+/// the first 15% of the budget, stays at 0.44 up to 65% and then
+/// falls exponentially. At the end of each chain the temperature is
+/// multiplied by the factor if the acceptance rate of the chain was
+/// above target, divided by it otherwise (the "modified Lam"
+/// schedule).
+///
+/// This schedule should be used with a chain length (see
+/// mets::simulated_annealing::chain_length()) of at least some
+/// tens of evaluated moves.
+class lam_cooling : public abstract_cooling_schedule {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param budget The evaluated moves of the whole search.
+    /// @param factor The temperature update factor (< 1).
+    explicit lam_cooling(unsigned long budget, double factor = 0.95)
+        : abstract_cooling_schedule(), budget_m(budget), factor_m(factor), spent_m(0), rate_m() {
+        if (factor >= 1 || factor <= 0) throw std::runtime_error("factor must be in (0, 1)");
+    }
+
+    void chain_end(const chain_statistics &stats) {
+        spent_m += stats.trials;
+        rate_m = stats.acceptance_rate();
+    }
+
+    double operator()(double temp, feasible_solution &fs) {
+        return rate_m > target() ? temp * factor_m : temp / factor_m;
+    }
+
+    /// @brief The target acceptance rate at this point of the search.
+    double target() const;
+
+    /// @brief Restarts the budget.
+    void reset() { spent_m = 0; }
+
+  protected:
+    unsigned long budget_m;
+    double factor_m;
+    unsigned long spent_m;
+    double rate_m;
+};
+
+/// @brief Decorates a cooling schedule raising the temperature when
+/// the search stalls (for Simulated Annealing).
+///
+/// When the best solution was not improved during the given number
+/// of consecutive chains the temperature is multiplied by the
+/// reheating factor, otherwise the decorated schedule is used.
+class reheating_cooling : public abstract_cooling_schedule {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param schedule The decorated schedule.
+    /// @param patience The chains without improvement before
+    /// reheating.
+    /// @param factor The reheating factor (> 1).
+    reheating_cooling(abstract_cooling_schedule &schedule, unsigned int patience,
+                      double factor = 2.0)
+        : abstract_cooling_schedule(),
+          schedule_m(schedule),
+          patience_m(patience),
+          factor_m(factor),
+          stalled_m(0),
+          reheats_m(0) {
+        if (factor <= 1) throw std::runtime_error("factor must be > 1");
+    }
+
+    void chain_end(const chain_statistics &stats) {
+        stalled_m = stats.improvements ? 0 : stalled_m + 1;
+        schedule_m.chain_end(stats);
+    }
+
+    double operator()(double temp, feasible_solution &fs) {
+        if (patience_m && stalled_m >= patience_m) {
+            stalled_m = 0;
+            ++reheats_m;
+            return temp * factor_m;
+        }
+        return schedule_m(temp, fs);
+    }
+
+    /// @brief Number of times the temperature was raised.
+    unsigned int reheats() const { return reheats_m; }
+
+  protected:
+    abstract_cooling_schedule &schedule_m;
+    unsigned int patience_m;
+    double factor_m;
+    unsigned int stalled_m;
+    unsigned int reheats_m;
+};
+
+/// @brief Starting and stopping temperatures for a simulated
+/// annealing, calibrated on the cost changes of the uphill moves.
+///
+/// @see mets::calibrate_temperature()
+struct temperature_calibration {
+    temperature_calibration() : starting_temp(), stop_temp(), samples() {}
+
+    /// @brief Calibrates the temperatures on the given uphill cost
+    /// changes.
+    ///
+    /// The cost changes not greater than epsilon are left out. The
+    /// starting temperature is the one where the mean Metropolis
+    /// acceptance probability of the remaining moves is
+    /// initial_acceptance (found by bisection), the stopping
+    /// temperature is the one where the smallest of them is accepted
+    /// with probability final_acceptance.
+    static temperature_calibration from_deltas(const std::vector<gol_type> &uphill,
+                                               double initial_acceptance,
+                                               double final_acceptance, double K,
+                                               gol_type epsilon = 1e-7);
+
+    /// @brief Draws the positions of the moves to sample.
+    ///
+    /// samples positions are drawn uniformly in [0, size), with
+    /// replacement and a fixed seed, and sorted: all the positions
+    /// are returned in order if size is not greater than samples.
+    static void sample_positions(unsigned long size, unsigned long samples,
+                                 std::vector<unsigned long> &positions);
+
+    /// @brief The starting temperature.
+    double starting_temp;
+    /// @brief The stopping temperature.
+    double stop_temp;
+    /// @brief The number of uphill moves sampled.
+    unsigned long samples;
+};
+
+/// @brief Calibrates the starting and stopping temperatures of a
+/// simulated annealing.
+///
+/// Up to samples moves of the neighborhood of sol are drawn at
+/// random (see mets::temperature_calibration::sample_positions())
+/// and evaluated, the uphill ones are used to calibrate the
+/// temperatures (see mets::temperature_calibration::from_deltas()).
+/// A std::runtime_error is thrown if there is no uphill move.
+///
+/// @param sol The starting solution (it is not modified).
+/// @param moveman The neighborhood to sample (it is refreshed on sol).
+/// @param initial_acceptance The mean acceptance probability of the
+/// uphill moves at the starting temperature.
+/// @param final_acceptance The acceptance probability of the smallest
+/// uphill move at the stopping temperature.
+/// @param K The "Boltzmann" constant of the search.
+/// @param samples The number of moves evaluated.
+/// @param epsilon The smallest cost change of an uphill move.
+template <typename move_manager_type>
+temperature_calibration calibrate_temperature(evaluable_solution &sol,
+                                              move_manager_type &moveman,
+                                              double initial_acceptance = 0.8,
+                                              double final_acceptance = 1e-3, double K = 1.0,
+                                              unsigned long samples = 1000,
+                                              gol_type epsilon = 1e-7);
+
+/// @brief Calibrates the starting and stopping temperatures of a
+/// simulated annealing, evaluating the moves on a pool of threads.
+///
+/// The move_manager_type iterator must be a random access iterator.
+/// The result is the same of the serial version.
+template <typename move_manager_type>
+temperature_calibration calibrate_temperature(evaluable_solution &sol,
+                                              move_manager_type &moveman, thread_pool &pool,
+                                              double initial_acceptance = 0.8,
+                                              double final_acceptance = 1e-3, double K = 1.0,
+                                              unsigned long samples = 1000,
+                                              gol_type epsilon = 1e-7);
+
 /// @}
 }  // namespace mets
 
+inline mets::temperature_calibration mets::temperature_calibration::from_deltas(
+        const std::vector<gol_type> &uphill, double initial_acceptance, double final_acceptance,
+        double K, gol_type epsilon) {
+    if (initial_acceptance <= 0 || initial_acceptance >= 1 || final_acceptance <= 0 ||
+        final_acceptance >= 1)
+        throw std::runtime_error("acceptance probabilities must be in (0, 1)");
+
+    std::vector<gol_type> deltas;
+    for (std::vector<gol_type>::const_iterator it = uphill.begin(); it != uphill.end(); ++it)
+        if (*it > epsilon) deltas.push_back(*it);
+    if (deltas.empty()) throw std::runtime_error("no uphill move to calibrate the temperature");
+
+    gol_type smallest = *std::min_element(deltas.begin(), deltas.end());
+    gol_type largest = *std::max_element(deltas.begin(), deltas.end());
+
+    // the mean acceptance is increasing with the temperature:
+    // bisection in the logarithm of the temperature
+    double low = std::log(smallest / K) - 10;
+    double high = std::log(largest / K) + 10;
+    for (int ii = 0; ii != 100 && high - low > 1e-9; ++ii) {
+        double middle = (low + high) / 2;
+        double kt = K * std::exp(middle);
+        double sum = 0;
+        for (std::vector<gol_type>::const_iterator it = deltas.begin(); it != deltas.end(); ++it)
+            sum += std::exp(-*it / kt);
+        if (sum / deltas.size() < initial_acceptance)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    temperature_calibration result;
+    result.starting_temp = std::exp((low + high) / 2);
+    result.stop_temp = -smallest / (K * std::log(final_acceptance));
+    result.samples = deltas.size();
+    return result;
+}
+
+inline void mets::temperature_calibration::sample_positions(
+        unsigned long size, unsigned long samples, std::vector<unsigned long> &positions) {
+    positions.clear();
+    if (size <= samples) {
+        for (unsigned long ii = 0; ii != size; ++ii) positions.push_back(ii);
+        return;
+    }
+#if defined(METSLIB_HAVE_UNORDERED_MAP) && !defined(METSLIB_TR1_MIXED_NAMESPACE)
+    std::mt19937 rng;
+    std::uniform_int_distribution<unsigned long> position(0, size - 1);
+    for (unsigned long ii = 0; ii != samples; ++ii) positions.push_back(position(rng));
+#else
+    std::tr1::mt19937 rng;
+    std::tr1::uniform_int<unsigned long> range(0, size - 1);
+    std::tr1::variate_generator<std::tr1::mt19937 &, std::tr1::uniform_int<unsigned long> >
+            position(rng, range);
+    for (unsigned long ii = 0; ii != samples; ++ii) positions.push_back(position());
+#endif
+    std::sort(positions.begin(), positions.end());
+}
+
+template <typename move_manager_t>
+mets::temperature_calibration mets::calibrate_temperature(evaluable_solution &sol,
+                                                          move_manager_t &moveman,
+                                                          double initial_acceptance,
+                                                          double final_acceptance, double K,
+                                                          unsigned long samples,
+                                                          gol_type epsilon) {
+    typedef typename move_manager_t::iterator iterator;
+    gol_type cost = sol.cost_function();
+    moveman.refresh(sol);
+    std::vector<unsigned long> positions;
+    temperature_calibration::sample_positions(std::distance(moveman.begin(), moveman.end()),
+                                              samples, positions);
+    // a single walk: the positions are sorted
+    std::vector<gol_type> uphill;
+    iterator movit = moveman.begin();
+    unsigned long at = 0;
+    for (std::vector<unsigned long>::const_iterator pos = positions.begin();
+         pos != positions.end(); ++pos) {
+        std::advance(movit, *pos - at);
+        at = *pos;
+        gol_type delta = (*movit)->evaluate(sol) - cost;
+        if (delta > epsilon) uphill.push_back(delta);
+    }
+    return temperature_calibration::from_deltas(uphill, initial_acceptance, final_acceptance, K,
+                                                epsilon);
+}
+
 template <typename move_manager_t>
-mets::simulated_annealing<move_manager_t>::simulated_annealing(
-        evaluable_solution &working, solution_recorder &recorder, move_manager_t &moveman,
-        termination_criteria_chain &tc, abstract_cooling_schedule &cs, double starting_temp,
-        double stop_temp, double K)
+mets::temperature_calibration mets::calibrate_temperature(evaluable_solution &sol,
+                                                          move_manager_t &moveman,
+                                                          thread_pool &pool,
+                                                          double initial_acceptance,
+                                                          double final_acceptance, double K,
+                                                          unsigned long samples,
+                                                          gol_type epsilon) {
+    typedef typename move_manager_t::iterator iterator;
+    moveman.refresh(sol);
+    const gol_type cost = sol.cost_function();
+    const iterator begin = moveman.begin();
+    std::vector<unsigned long> positions;
+    temperature_calibration::sample_positions(std::distance(begin, moveman.end()), samples,
+                                              positions);
+    const unsigned long size = positions.size();
+    const unsigned int chunks = pool.size();
+    std::vector<std::vector<gol_type> > found(chunks);
+
+    auto sample = [&](unsigned int chunk) {
+        for (unsigned long ii = size * chunk / chunks; ii != size * (chunk + 1) / chunks; ++ii) {
+            gol_type delta = (*(begin + positions[ii]))->evaluate(sol) - cost;
+            if (delta > epsilon) found[chunk].push_back(delta);
+        }
+    };
+    pool.run(chunks, sample);
+
+    std::vector<gol_type> uphill;
+    for (unsigned int chunk = 0; chunk != chunks; ++chunk)
+        uphill.insert(uphill.end(), found[chunk].begin(), found[chunk].end());
+    return temperature_calibration::from_deltas(uphill, initial_acceptance, final_acceptance, K,
+                                                epsilon);
+}
+
+inline double mets::lam_cooling::target() const {
+    double t = budget_m ? double(spent_m) / budget_m : 1.0;
+    if (t < 0.15) return 0.44 + 0.56 * std::pow(560.0, -t / 0.15);
+    if (t < 0.65) return 0.44;
+    return 0.44 * std::pow(440.0, -(t - 0.65) / 0.35);
+}
+
+template <typename generator>
+unsigned int mets::metropolis_acceptance::first(const gol_type *costs, unsigned int size,
+                                                gol_type current, generator &uniform) {
+    for (unsigned int ii = 0; ii != size; ++ii)
+        if ((*this)((double)(costs[ii] - current), uniform)) return ii;
+    return size;
+}
+
+template <typename generator>
+unsigned int mets::threshold_acceptance::first(const gol_type *costs, unsigned int size,
+                                               gol_type current, generator &uniform) {
+    const unsigned int block = 8;
+    unsigned int ii = 0;
+    while (ii != size) {
+        if (left_m == 0) draw(uniform);
+        unsigned int last = ii + std::min(left_m, size - ii);
+        const gol_type bound = current + threshold_m;
+        // whole blocks without branches, then find the accepted move
+        unsigned int found = ii;
+        for (; found + block <= last; found += block) {
+            bool any = false;
+            for (unsigned int jj = 0; jj != block; ++jj) any |= costs[found + jj] < bound;
+            if (any) break;
+        }
+        for (; found != last; ++found)
+            if (costs[found] < bound) {
+                left_m -= found + 1 - ii;
+                return found;
+            }
+        left_m -= last - ii;
+        ii = last;
+    }
+    return size;
+}
+
+#define METS_SIMULATED_ANNEALING_TEMPLATE_                                             \
+    template <typename move_manager_t, typename solution_t, typename recorder_t,          \
+              typename termination_t, typename cooling_t, typename acceptance_t>
+
+METS_SIMULATED_ANNEALING_TEMPLATE_
+mets::simulated_annealing<move_manager_t, solution_t, recorder_t, termination_t, cooling_t,
+                          acceptance_t>::
+        simulated_annealing(solution_t &working, recorder_t &recorder, move_manager_t &moveman,
+                            termination_t &tc, cooling_t &cs, double starting_temp,
+                            double stop_temp, double K, const acceptance_t &acceptance)
     : abstract_search<move_manager_t>(working, recorder, moveman),
+      working_m(working),
+      recorder_m(recorder),
       termination_criteria_m(tc),
       cooling_schedule_m(cs),
       starting_temp_m(starting_temp),
       stop_temp_m(stop_temp),
       current_temp_m(),
       K_m(K),
+      chain_trials_m(0),
+      chain_accepted_m(0),
+      chain_m(),
+      acceptance_m(acceptance),
       ureal(0.0, 1.0),
-      rng(),
-      gen(rng, ureal) {}
+      rng()
+#if !defined(METSLIB_HAVE_UNORDERED_MAP) || defined(METSLIB_TR1_MIXED_NAMESPACE)
+      ,
+      gen(rng, ureal)
+#endif
+{
+}
 
-template <typename move_manager_t>
-void mets::simulated_annealing<move_manager_t>::search() {
+METS_SIMULATED_ANNEALING_TEMPLATE_
+void mets::simulated_annealing<move_manager_t, solution_t, recorder_t, termination_t, cooling_t,
+                               acceptance_t>::search() {
     typedef abstract_search<move_manager_t> base_t;
+    search_statistics &stats = base_t::statistics_m;
 
     current_temp_m = starting_temp_m;
-    while (!termination_criteria_m(base_t::working_solution_m) && current_temp_m > stop_temp_m) {
-        gol_type actual_cost =
-                static_cast<mets::evaluable_solution &>(base_t::working_solution_m).cost_function();
-        gol_type best_cost =
-                static_cast<mets::evaluable_solution &>(base_t::working_solution_m).cost_function();
+    chain_m = chain_statistics();
+    chain_m.temperature = current_temp_m;
+    this->start_event();
+    while (!this->stop_requested() && !termination_criteria_m(working_m) &&
+           current_temp_m > stop_temp_m) {
+        this->iteration_event(current_temp_m);
+        this->notify_step(base_t::ITERATION_BEGIN);
+        gol_type actual_cost = working_m.cost_function();
+        unsigned long trials = 0;
+        bool accepted = false;
+        bool improved = false;
+
+        this->begin_phase(phase_listener::REFRESH);
+        unsigned long long start = stats.start();
+        base_t::moves_m.refresh(working_m);
+        stats.stop(search_statistics::REFRESH_NS, start);
+        stats.add(search_statistics::REFRESHES, 1);
+        this->end_phase(phase_listener::REFRESH);
 
-        base_t::moves_m.refresh(base_t::working_solution_m);
+        this->begin_phase(phase_listener::EVALUATE);
+        acceptance_m.start(K_m * current_temp_m);
         for (typename move_manager_t::iterator movit = base_t::moves_m.begin();
              movit != base_t::moves_m.end(); ++movit) {
             // apply move and record proposed cost function
-            gol_type cost = (*movit)->evaluate(base_t::working_solution_m);
+            start = stats.start();
+            gol_type cost = (*movit)->evaluate(working_m);
+            stats.stop(search_statistics::EVALUATE_NS, start);
+            ++trials;
 
             double delta = ((double)(cost - actual_cost));
-            if (delta < 0 || gen() < exp(-delta / (K_m * current_temp_m))) {
+            if (accept(delta)) {
                 // accepted: apply, record, exit for and lower temperature
-                (*movit)->apply(base_t::working_solution_m);
-                base_t::current_move_m = movit;
-
-                if (base_t::solution_recorder_m.accept(base_t::working_solution_m)) {
-                    base_t::step_m = base_t::IMPROVEMENT_MADE;
-                    this->notify();
-                }
-                base_t::step_m = base_t::MOVE_MADE;
-                this->notify();
+                accepted = true;
+                this->end_phase(phase_listener::EVALUATE);
+                improved = make_move(movit, trials - 1, cost, delta);
                 break;
             }
         }  // end for each move
+        if (!accepted) this->end_phase(phase_listener::EVALUATE);
 
-        current_temp_m = cooling_schedule_m(current_temp_m, base_t::working_solution_m);
+        stats.add(search_statistics::MOVES_EVALUATED, trials);
+        end_iteration(trials, accepted, improved);
+        this->notify_step(base_t::ITERATION_END);
     }
 }
+
+METS_SIMULATED_ANNEALING_TEMPLATE_
+void mets::simulated_annealing<move_manager_t, solution_t, recorder_t, termination_t, cooling_t,
+                               acceptance_t>::end_iteration(unsigned long trials, bool accepted,
+                                                            bool improved) {
+    this->statistics_m.add(search_statistics::MOVES_REJECTED, trials - accepted);
+    ++chain_m.iterations;
+    chain_m.trials += trials;
+    chain_m.accepted += accepted;
+    chain_m.improvements += improved;
+    bool every_iteration = !chain_trials_m && !chain_accepted_m;
+    bool trials_done = chain_trials_m && chain_m.trials >= chain_trials_m;
+    bool accepted_done = chain_accepted_m && chain_m.accepted >= chain_accepted_m;
+    if (!every_iteration && !trials_done && !accepted_done) return;
+
+    cooling_schedule_m.chain_end(chain_m);
+    current_temp_m = cooling_schedule_m(current_temp_m, working_m);
+    chain_m = chain_statistics();
+    chain_m.temperature = current_temp_m;
+}
+
+METS_SIMULATED_ANNEALING_TEMPLATE_
+bool mets::simulated_annealing<move_manager_t, solution_t, recorder_t, termination_t, cooling_t,
+                               acceptance_t>::make_move(iterator movit, long index,
+                                                        gol_type cost, gol_type delta) {
+    typedef abstract_search<move_manager_t> base_t;
+    this->begin_phase(phase_listener::APPLY);
+    unsigned long long start = base_t::statistics_m.start();
+    (*movit)->apply(working_m);
+    base_t::statistics_m.stop(search_statistics::APPLY_NS, start);
+    this->end_phase(phase_listener::APPLY);
+    base_t::statistics_m.add(search_statistics::MOVES_ACCEPTED, 1);
+    base_t::current_move_m = movit;
+    this->move_event(index, cost, delta);
+
+    bool improved = recorder_m.accept(working_m);
+    if (improved) {
+        base_t::statistics_m.add(search_statistics::IMPROVEMENTS, 1);
+        this->notify_step(base_t::IMPROVEMENT_MADE);
+    }
+    this->notify_step(base_t::MOVE_MADE);
+    return improved;
+}
+
+METS_SIMULATED_ANNEALING_TEMPLATE_
+mets::parallel_simulated_annealing<move_manager_t, solution_t, recorder_t, termination_t,
+                                   cooling_t, acceptance_t>::
+        parallel_simulated_annealing(solution_t &working, recorder_t &recorder,
+                                     move_manager_t &moveman, termination_t &tc, cooling_t &cs,
+                                     double starting_temp, thread_pool &pool, unsigned int batch,
+                                     double stop_temp, double K, const acceptance_t &acceptance)
+    : annealing_type(working, recorder, moveman, tc, cs, starting_temp, stop_temp, K,
+                     acceptance),
+      pool_m(pool),
+      batch_m(batch ? batch : 8 * pool.size()),
+      costs_m(batch_m) {}
+
+METS_SIMULATED_ANNEALING_TEMPLATE_
+void mets::parallel_simulated_annealing<move_manager_t, solution_t, recorder_t, termination_t,
+                                        cooling_t, acceptance_t>::batch_evaluation::
+operator()(unsigned int chunk) {
+    unsigned int first = size_m * chunk / chunks_m;
+    unsigned int last = size_m * (chunk + 1) / chunks_m;
+    iterator movit = begin_m + first;
+    for (unsigned int ii = first; ii != last; ++ii, ++movit)
+        search_m.costs_m[ii] = (*movit)->evaluate(search_m.working_m);
+}
+
+METS_SIMULATED_ANNEALING_TEMPLATE_
+void mets::parallel_simulated_annealing<move_manager_t, solution_t, recorder_t, termination_t,
+                                        cooling_t, acceptance_t>::search() {
+    typedef abstract_search<move_manager_t> base_t;
+    typedef annealing_type sa_t;
+    search_statistics &stats = base_t::statistics_m;
+
+    sa_t::current_temp_m = sa_t::starting_temp_m;
+    sa_t::chain_m = chain_statistics();
+    sa_t::chain_m.temperature = sa_t::current_temp_m;
+    this->start_event();
+    while (!this->stop_requested() && !sa_t::termination_criteria_m(sa_t::working_m) &&
+           sa_t::current_temp_m > sa_t::stop_temp_m) {
+        this->iteration_event(sa_t::current_temp_m);
+        this->notify_step(base_t::ITERATION_BEGIN);
+        gol_type actual_cost = sa_t::working_m.cost_function();
+        unsigned long trials = 0;
+        bool accepted = false;
+        bool improved = false;
+
+        this->begin_phase(phase_listener::REFRESH);
+        unsigned long long start = stats.start();
+        base_t::moves_m.refresh(sa_t::working_m);
+        stats.stop(search_statistics::REFRESH_NS, start);
+        stats.add(search_statistics::REFRESHES, 1);
+        this->end_phase(phase_listener::REFRESH);
+
+        this->begin_phase(phase_listener::EVALUATE);
+        sa_t::acceptance_m.start(sa_t::K_m * sa_t::current_temp_m);
+        typename sa_t::uniform_generator generator = {*this};
+        iterator end = base_t::moves_m.end();
+        for (iterator batch = base_t::moves_m.begin(); batch != end;) {
+            unsigned int size = batch_m;
+            if (end - batch < size) size = end - batch;
+            unsigned int chunks = std::min(size, pool_m.size());
+            batch_evaluation evaluation(*this, batch, size, chunks);
+            start = stats.start();
+            pool_m.run(chunks, evaluation);
+            stats.stop(search_statistics::EVALUATE_NS, start);
+            stats.add(search_statistics::MOVES_EVALUATED, size);
+
+            // commit the first accepted move in sequence order
+            unsigned int first =
+                    sa_t::acceptance_m.first(&costs_m[0], size, actual_cost, generator);
+            if (first != size) {
+                // the moves following the accepted one do not count
+                trials += first + 1;
+                accepted = true;
+                this->end_phase(phase_listener::EVALUATE);
+                improved = sa_t::make_move(batch + first, trials - 1, costs_m[first],
+                                           costs_m[first] - actual_cost);
+                break;
+            }
+            trials += size;
+            batch += size;
+        }
+        if (!accepted) this->end_phase(phase_listener::EVALUATE);
+
+        sa_t::end_iteration(trials, accepted, improved);
+        this->notify_step(base_t::ITERATION_END);
+    }
+}
+
+#undef METS_SIMULATED_ANNEALING_TEMPLATE_
+
 #endif
@@ -159,10 +159,30 @@ class tabu_list_chain {
 /// different solvers decorating tabu_search class in different
 /// ways.
 ///
-template <typename move_manager_type>
+/// Apart from the move_manager_type, the template parameters are the
+/// types of the solution and of the components the search is made
+/// of. By default they are the abstract interfaces of the library, so
+/// that any solution and component can be used through virtual
+/// calls. Instantiating the search on the concrete types (this is
+/// what happens with class template argument deduction, e.g.
+/// <code>mets::tabu_search ts(sol, rec, moves, tabus, asp, term);</code>)
+/// the statically typed overloads provided by the library components
+/// (e.g. mets::swap_tabu_matrix, mets::basic_best_ever_criteria) are
+/// called instead, without any dynamic_cast and with calls that the
+/// compiler can inline. In this case the move_manager_type iterator
+/// should return pointers to the concrete move type (as the
+/// mets::implicit_neighborhood does).
+///
+template <typename move_manager_type, typename solution_type = feasible_solution,
+          typename recorder_type = solution_recorder, typename tabu_list_type = tabu_list_chain,
+          typename aspiration_type = aspiration_criteria_chain,
+          typename termination_type = termination_criteria_chain,
+          typename observer_policy = attached_observers>
 class tabu_search : public abstract_search<move_manager_type> {
   public:
-    typedef tabu_search<move_manager_type> search_type;
+    typedef tabu_search<move_manager_type, solution_type, recorder_type, tabu_list_type,
+                        aspiration_type, termination_type, observer_policy>
+            search_type;
     /// @brief Creates a tabu Search instance.
     ///
     /// @param starting_solution  The working solution (this
@@ -185,9 +205,9 @@ class tabu_search : public abstract_search<move_manager_type> {
     /// Annealing: you can give a termination criteria that termiantes
     /// when temperature reaches 0.
     ///
-    tabu_search(feasible_solution &starting_solution, solution_recorder &best_recorder,
-                move_manager_type &move_manager_inst, tabu_list_chain &tabus,
-                aspiration_criteria_chain &aspiration, termination_criteria_chain &termination);
+    tabu_search(solution_type &starting_solution, recorder_type &best_recorder,
+                move_manager_type &move_manager_inst, tabu_list_type &tabus,
+                aspiration_type &aspiration, termination_type &termination);
 
     tabu_search(const search_type &);
     search_type &operator=(const search_type &);
@@ -205,22 +225,104 @@ class tabu_search : public abstract_search<move_manager_type> {
     enum { ASPIRATION_CRITERIA_MET = abstract_search<move_manager_type>::LAST, LAST };
 
     /// @brief The tabu list used by this tabu search
-    const tabu_list_chain &get_tabu_list() const { return tabu_list_m; }
+    const tabu_list_type &get_tabu_list() const { return tabu_list_m; }
 
     /// @brief The aspiration criteria used by this tabu search
-    const aspiration_criteria_chain &get_aspiration_criteria() const {
-        return aspiration_criteria_m;
-    }
+    const aspiration_type &get_aspiration_criteria() const { return aspiration_criteria_m; }
 
     /// @brief The termination criteria used by this tabu search
-    const termination_criteria_chain &get_termination_criteria() const {
-        return termination_criteria_m;
-    }
+    const termination_type &get_termination_criteria() const { return termination_criteria_m; }
+
+  protected:
+    solution_type &working_m;
+    recorder_type &recorder_m;
+    tabu_list_type &tabu_list_m;
+    aspiration_type &aspiration_criteria_m;
+    termination_type &termination_criteria_m;
+};
+
+/// @brief Tabu Search algorithm evaluating the neighborhood in
+/// parallel.
+///
+/// The move range [begin(), end()) is split in contiguous chunks
+/// that are evaluated by the threads of a mets::thread_pool. Each
+/// thread records the admissible moves improving over the best move
+/// of its own chunk, the chunks are then merged in neighborhood
+/// order so that the chosen move, the aspiration notifications and
+/// their order are exactly the ones of the serial
+/// mets::tabu_search (ties are won by the first move in neighborhood
+/// order). Results are therefore reproducible and do not depend on
+/// the number of threads.
+///
+/// The move_manager_type iterator must be a random access iterator,
+/// and move evaluation, mets::tabu_list_chain::is_tabu() and the
+/// aspiration criteria operator() must be safe to be called
+/// concurrently on the same solution (they are const).
+///
+template <typename move_manager_type, typename solution_type = feasible_solution,
+          typename recorder_type = solution_recorder, typename tabu_list_type = tabu_list_chain,
+          typename aspiration_type = aspiration_criteria_chain,
+          typename termination_type = termination_criteria_chain,
+          typename observer_policy = attached_observers>
+class parallel_tabu_search
+    : public tabu_search<move_manager_type, solution_type, recorder_type, tabu_list_type,
+                         aspiration_type, termination_type, observer_policy> {
+  public:
+    typedef parallel_tabu_search<move_manager_type, solution_type, recorder_type, tabu_list_type,
+                                 aspiration_type, termination_type, observer_policy>
+            search_type;
+    typedef tabu_search<move_manager_type, solution_type, recorder_type, tabu_list_type,
+                        aspiration_type, termination_type, observer_policy>
+            tabu_search_type;
+    /// @brief Creates a parallel tabu Search instance.
+    ///
+    /// Parameters are the same of mets::tabu_search, in addition:
+    ///
+    /// @param pool The threads used to evaluate the neighborhood.
+    ///
+    parallel_tabu_search(solution_type &starting_solution, recorder_type &best_recorder,
+                         move_manager_type &move_manager_inst, tabu_list_type &tabus,
+                         aspiration_type &aspiration, termination_type &termination,
+                         thread_pool &pool);
+
+    parallel_tabu_search(const search_type &);
+    search_type &operator=(const search_type &);
+
+    /// @brief This method starts the tabu search process.
+    ///
+    /// An exception mets::no_moves_error is risen when no move
+    /// is possible.
+    void search();
 
   protected:
-    tabu_list_chain &tabu_list_m;
-    aspiration_criteria_chain &aspiration_criteria_m;
-    termination_criteria_chain &termination_criteria_m;
+    typedef typename move_manager_type::iterator iterator;
+
+    /// @brief A move improving over the previous ones of its chunk.
+    struct candidate {
+        iterator movit;
+        gol_type cost;
+        bool aspiration;
+    };
+
+    /// @brief Evaluation of one chunk of the neighborhood.
+    class chunk_evaluation {
+      public:
+        chunk_evaluation(search_type &search, iterator begin, typename std::iterator_traits<
+                iterator>::difference_type size, unsigned int chunks)
+            : search_m(search), begin_m(begin), size_m(size), chunks_m(chunks) {}
+        void operator()(unsigned int chunk);
+
+      protected:
+        search_type &search_m;
+        iterator begin_m;
+        typename std::iterator_traits<iterator>::difference_type size_m;
+        unsigned int chunks_m;
+    };
+
+    thread_pool &pool_m;
+    std::vector<std::vector<candidate> > candidates_m;
+    /// @brief The tabu moves met by each chunk.
+    std::vector<unsigned long> tabu_hits_m;
 };
 
 /// @brief Simplistic implementation of a tabu-list.
@@ -236,20 +338,40 @@ class tabu_search : public abstract_search<move_manager_type> {
 ///
 /// A mets::mana_move is tabu if it's in the tabu list by means
 /// of its operator== and hash function.
+///
+/// The nodes of the list and the clones of the moves that implement
+/// mets::mana_move::opposite_in() are allocated from a pool owned by
+/// the list: once warmed up the list reuses the memory of the expired
+/// moves and does not call the global allocator, nor the upstream
+/// resource. The other moves are cloned with opposite_of().
 class simple_tabu_list : public tabu_list_chain {
   public:
     /// @brief Ctor. Makes a tabu list of the specified tenure.
     ///
     /// @param tenure Tenure (length) of the tabu list
-    simple_tabu_list(unsigned int tenure)
-        : tabu_list_chain(tenure), tabu_moves_m(), tabu_hash_m(tenure) {}
+    /// @param upstream The resource the pool of the list gets its
+    /// memory from
+    simple_tabu_list(unsigned int tenure,
+                     std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : tabu_list_chain(tenure),
+          pool_m(upstream),
+          tabu_moves_m(&pool_m),
+          tabu_hash_m(tenure, mana_move_hash(), dereferenced_equal_to<const mana_move *>(),
+                      &pool_m) {}
 
     /// @brief Ctor. Makes a tabu list of the specified tenure.
     ///
     /// @param tenure Tenure (length) of the tabu list
     /// @param next Next list to invoke when this returns false
-    simple_tabu_list(tabu_list_chain *next, unsigned int tenure)
-        : tabu_list_chain(next, tenure), tabu_moves_m(), tabu_hash_m(tenure) {}
+    /// @param upstream The resource the pool of the list gets its
+    /// memory from
+    simple_tabu_list(tabu_list_chain *next, unsigned int tenure,
+                     std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : tabu_list_chain(next, tenure),
+          pool_m(upstream),
+          tabu_moves_m(&pool_m),
+          tabu_hash_m(tenure, mana_move_hash(), dereferenced_equal_to<const mana_move *>(),
+                      &pool_m) {}
 
     /// @brief Destructor
     ~simple_tabu_list();
@@ -260,7 +382,12 @@ class simple_tabu_list : public tabu_list_chain {
     ///
     /// @param sol The current working solution
     /// @param mov The move to make tabu
-    void tabu(const feasible_solution &sol, const move &mov);
+    void tabu(const feasible_solution &sol, const move &mov) {
+        tabu(sol, dynamic_cast<const mana_move &>(mov));
+    }
+
+    /// @brief Statically typed (non virtual) version of tabu().
+    void tabu(const feasible_solution &sol, const mana_move &mov);
 
     /// @brief True if the move is tabu for the given solution.
     ///
@@ -271,27 +398,390 @@ class simple_tabu_list : public tabu_list_chain {
     /// @param mov The move to make tabu
     /// @return True if this move was already made during the last
     /// tenure iterations
-    bool is_tabu(const feasible_solution &sol, const move &mov) const;
+    bool is_tabu(const feasible_solution &sol, const move &mov) const {
+        return is_tabu(sol, dynamic_cast<const mana_move &>(mov));
+    }
+
+    /// @brief Statically typed (non virtual) version of is_tabu().
+    bool is_tabu(const feasible_solution &sol, const mana_move &mov) const;
 
   protected:
-    typedef std::deque<const move *> move_list_type;
+    /// @brief A move in the list.
+    struct tabu_entry {
+        /// @brief The number of times the move is in the list.
+        int count;
+        /// @brief True if the clone was made by opposite_in().
+        bool pooled;
+    };
+
+    typedef std::pmr::deque<const mana_move *> move_list_type;
 #if defined(METSLIB_HAVE_UNORDERED_MAP) && !defined(METSLIB_TR1_MIXED_NAMESPACE)
-    typedef std::unordered_map<const mana_move *,  // Key type
-                               int,  // insert a move and the number of times it's present in the
-                                     // list
-                               mana_move_hash, dereferenced_equal_to<const mana_move *> >
+    typedef std::pmr::unordered_map<const mana_move *,  // Key type
+                                    tabu_entry,         // the move and how many times it's
+                                                        // present in the list
+                                    mana_move_hash, dereferenced_equal_to<const mana_move *> >
             move_map_type;
 #else
-    typedef std::tr1::unordered_map<const mana_move *,  // Key type
-                                    int,  // insert a move and the number of times it's present in
-                                          // the list
-                                    mana_move_hash, dereferenced_equal_to<const mana_move *> >
+    typedef std::tr1::unordered_map<
+            const mana_move *,  // Key type
+            tabu_entry,         // the move and how many times it's present in the list
+            mana_move_hash, dereferenced_equal_to<const mana_move *>,
+            std::pmr::polymorphic_allocator<std::pair<const mana_move *const, tabu_entry> > >
             move_map_type;
 #endif
+
+    /// @brief Destroys a clone made by tabu().
+    void release(const mana_move *m, bool pooled) {
+        if (pooled)
+            mana_move::destroy_in(pool_m, m);
+        else
+            delete m;
+    }
+
+    std::pmr::unsynchronized_pool_resource pool_m;
     move_list_type tabu_moves_m;
     move_map_type tabu_hash_m;
 };
 
+/// @brief Cache friendly tabu list for any mets::mana_move with a
+/// key (see mets::mana_move::key()).
+///
+/// Behaves as the mets::simple_tabu_list, but stores the keys of the
+/// moves (see mets::mana_move::opposite_key()) inline in an open
+/// addressing hash table with linear probing, kept at most half full,
+/// and the tenure queue in a ring buffer. is_tabu() hashes the key
+/// and usually reads a single cache line; tabu() does not allocate
+/// once warmed up.
+class flat_tabu_list : public tabu_list_chain {
+  public:
+    /// @brief Ctor. Makes a tabu list of the specified tenure.
+    ///
+    /// @param tenure Tenure (length) of the tabu list
+    flat_tabu_list(unsigned int tenure)
+        : tabu_list_chain(tenure), table_m(), mask_m(0), distinct_m(0), queue_m(), head_m(0),
+          queued_m(0) {
+        reserve(tenure);
+    }
+
+    /// @brief Ctor. Makes a tabu list of the specified tenure.
+    ///
+    /// @param tenure Tenure (length) of the tabu list
+    /// @param next Next list to invoke when this returns false
+    flat_tabu_list(tabu_list_chain *next, unsigned int tenure)
+        : tabu_list_chain(next, tenure), table_m(), mask_m(0), distinct_m(0), queue_m(),
+          head_m(0), queued_m(0) {
+        reserve(tenure);
+    }
+
+    /// @brief Make move a tabu.
+    ///
+    /// @param sol The current working solution
+    /// @param mov The move to make tabu
+    void tabu(const feasible_solution &sol, const move &mov) {
+        tabu(sol, dynamic_cast<const mana_move &>(mov));
+    }
+
+    /// @brief Statically typed (non virtual) version of tabu().
+    void tabu(const feasible_solution &sol, const mana_move &mov);
+
+    /// @brief True if the move is tabu for the given solution.
+    ///
+    /// @param sol The current working solution
+    /// @param mov The move to check
+    bool is_tabu(const feasible_solution &sol, const move &mov) const {
+        return is_tabu(sol, dynamic_cast<const mana_move &>(mov));
+    }
+
+    /// @brief Statically typed (non virtual) version of is_tabu().
+    bool is_tabu(const feasible_solution &sol, const mana_move &mov) const {
+        if (table_m[find(mov.key())].count) return true;
+        return tabu_list_chain::is_tabu(sol, mov);
+    }
+
+    /// @brief Tenure of the list.
+    unsigned int tenure() const { return tabu_list_chain::tenure(); }
+
+    /// @brief Changes the tenure, growing the table if needed.
+    ///
+    /// As in the mets::simple_tabu_list, the moves in excess expire
+    /// at the next call to tabu().
+    void tenure(unsigned int tenure) {
+        tabu_list_chain::tenure(tenure);
+        reserve(tenure);
+    }
+
+  protected:
+    /// @brief An entry of the table, count is the number of times
+    /// the key is in the queue (0 for an empty slot).
+    struct slot {
+        move_key key;
+        unsigned long long count;
+    };
+
+    /// @brief The slot of key, or the empty slot where it would go.
+    size_t find(const move_key &key) const {
+        size_t ii = static_cast<size_t>(key.hash()) & mask_m;
+        while (table_m[ii].count && table_m[ii].key != key) ii = (ii + 1) & mask_m;
+        return ii;
+    }
+
+    /// @brief Empties a slot, shifting back the following keys.
+    void erase(size_t hole);
+
+    /// @brief Makes room for tenure + 1 distinct keys.
+    void reserve(unsigned int tenure);
+
+    /// @brief Appends a key to the ring buffer.
+    void push(const move_key &key);
+
+    std::vector<slot> table_m;
+    size_t mask_m;
+    size_t distinct_m;
+    std::vector<move_key> queue_m;
+    size_t head_m;
+    size_t queued_m;
+};
+
+/// @brief Tabu list for mets::swap_elements moves on a
+/// mets::permutation_problem of known size.
+///
+/// Instead of storing clones of the moves, this list keeps a flag for
+/// each pair of positions and links the tabu pairs in a list, from
+/// the least to the most recently made tabu. is_tabu() is a single
+/// lookup and tabu() does not allocate.
+///
+/// The tabu moves are the same of the mets::simple_tabu_list: the
+/// last tenure() different moves made tabu. Making tabu an already
+/// tabu move (e.g. when the aspiration criteria is met) moves it to
+/// the end of the list, and the moves in excess expire at the next
+/// call to tabu().
+///
+/// Moves must be of mets::swap_elements type (this is not checked).
+class swap_tabu_matrix : public tabu_list_chain {
+  public:
+    /// @brief Ctor. Makes a tabu list of the specified tenure.
+    ///
+    /// @param size The size of the permutation problem
+    /// @param tenure Tenure (length) of the tabu list
+    swap_tabu_matrix(int size, unsigned int tenure)
+        : tabu_list_chain(tenure), count_m(0), tabu_m(), links_m() {
+        init(size);
+    }
+
+    /// @brief Ctor. Makes a tabu list of the specified tenure.
+    ///
+    /// @param next Next list to invoke when this returns false
+    /// @param size The size of the permutation problem
+    /// @param tenure Tenure (length) of the tabu list
+    swap_tabu_matrix(tabu_list_chain *next, int size, unsigned int tenure)
+        : tabu_list_chain(next, tenure), count_m(0), tabu_m(), links_m() {
+        init(size);
+    }
+
+    /// @brief Make move a tabu.
+    ///
+    /// @param sol The current working solution
+    /// @param mov The move to make tabu (a mets::swap_elements)
+    void tabu(const feasible_solution &sol, const move &mov) {
+        tabu(sol, static_cast<const swap_elements &>(mov));
+    }
+
+    /// @brief Statically typed (non virtual) version of tabu().
+    void tabu(const feasible_solution &sol, const swap_elements &mov);
+
+    /// @brief True if the move is tabu for the given solution.
+    ///
+    /// @param sol The current working solution
+    /// @param mov The move to check (a mets::swap_elements)
+    /// @return True if this move is one of the last tenure different
+    /// moves made tabu
+    bool is_tabu(const feasible_solution &sol, const move &mov) const {
+        return is_tabu(sol, static_cast<const swap_elements &>(mov));
+    }
+
+    /// @brief Statically typed (non virtual) version of is_tabu().
+    bool is_tabu(const feasible_solution &sol, const swap_elements &mov) const;
+
+  protected:
+    /// @brief Index of the (p1, p2) pair in the triangular matrix.
+    static size_t index(const swap_elements &m) {
+        return size_t(m.second()) * (m.second() - 1) / 2 + m.first();
+    }
+
+    /// @brief The neighbours of a pair in the list of the tabu pairs.
+    struct link {
+        size_t prev;
+        size_t next;
+    };
+
+    /// @brief Allocates the flags and the links, the list is empty.
+    void init(int size) {
+        const size_t pairs = size_t(size) * (size - 1) / 2;
+        tabu_m.assign(pairs, false);
+        // the last link is the head of the circular list
+        link head = {pairs, pairs};
+        links_m.assign(pairs + 1, head);
+    }
+
+    /// @brief Removes a pair from the list.
+    void unlink(size_t ii) {
+        links_m[links_m[ii].prev].next = links_m[ii].next;
+        links_m[links_m[ii].next].prev = links_m[ii].prev;
+    }
+
+    /// @brief Appends a pair to the list (the most recent).
+    void append(size_t ii) {
+        const size_t head = links_m.size() - 1;
+        links_m[ii].prev = links_m[head].prev;
+        links_m[ii].next = head;
+        links_m[links_m[head].prev].next = ii;
+        links_m[head].prev = ii;
+    }
+
+    /// @brief The number of tabu pairs.
+    unsigned int count_m;
+    std::vector<bool> tabu_m;
+    std::vector<link> links_m;
+};
+
+/// @brief Element/position tabu list for mets::permutation_problem
+/// (the memory of Taillard's Robust Tabu Search).
+///
+/// Making tabu a move that takes element e away from position p
+/// forbids e to go back to p for a number of iterations drawn
+/// uniformly in [tmin, tmax] at each move. A move is tabu when it
+/// would put back both the elements it moves. The iterations are
+/// counted by the calls to tabu().
+///
+/// Works with mets::swap_elements and mets::invert_subsequence moves
+/// (an inversion is tabu when the swap of its endpoints is): the
+/// memory is a dense size x size matrix, checks are O(1) and nothing
+/// is allocated after construction. The list must be told about the
+/// moves before they are applied, as the mets::tabu_search does.
+class element_position_tabu_list : public tabu_list_chain {
+  public:
+    /// @brief Ctor.
+    ///
+    /// @param size The size of the permutation problem
+    /// @param tmin The minimum tenure
+    /// @param tmax The maximum tenure (the tenure() of the list)
+    /// @param seed Seed of the random tenures
+    element_position_tabu_list(int size, unsigned int tmin, unsigned int tmax,
+                               unsigned long long seed = 0)
+        : tabu_list_chain(tmax), size_m(size), tmin_m(std::min(tmin, tmax)),
+          base_tmin_m(tmin_m), base_tmax_m(tmax), clock_m(0), state_m(seed),
+          until_m(size_t(size) * size, 0) {}
+
+    /// @brief Ctor.
+    ///
+    /// @param next Next list to invoke when this returns false
+    /// @param size The size of the permutation problem
+    /// @param tmin The minimum tenure
+    /// @param tmax The maximum tenure (the tenure() of the list)
+    /// @param seed Seed of the random tenures
+    element_position_tabu_list(tabu_list_chain *next, int size, unsigned int tmin,
+                               unsigned int tmax, unsigned long long seed = 0)
+        : tabu_list_chain(next, tmax), size_m(size), tmin_m(std::min(tmin, tmax)),
+          base_tmin_m(tmin_m), base_tmax_m(tmax), clock_m(0), state_m(seed),
+          until_m(size_t(size) * size, 0) {}
+
+    /// @brief Make move a tabu.
+    ///
+    /// @param sol The current working solution (a
+    /// mets::permutation_problem), before the move
+    /// @param mov The move to make tabu (a mets::swap_elements or a
+    /// mets::invert_subsequence)
+    void tabu(const feasible_solution &sol, const move &mov) {
+        if (const swap_elements *swap = dynamic_cast<const swap_elements *>(&mov))
+            tabu(sol, *swap);
+        else
+            tabu(sol, dynamic_cast<const invert_subsequence &>(mov));
+    }
+
+    /// @brief Statically typed (non virtual) version of tabu().
+    void tabu(const feasible_solution &sol, const swap_elements &mov) {
+        tabu_positions(static_cast<const permutation_problem &>(sol), mov.first(), mov.second());
+        tabu_list_chain::tabu(sol, mov);
+    }
+
+    /// @brief Statically typed (non virtual) version of tabu().
+    void tabu(const feasible_solution &sol, const invert_subsequence &mov) {
+        tabu_positions(static_cast<const permutation_problem &>(sol), mov.first(), mov.second());
+        tabu_list_chain::tabu(sol, mov);
+    }
+
+    /// @brief True if the move is tabu for the given solution.
+    ///
+    /// @param sol The current working solution (a
+    /// mets::permutation_problem)
+    /// @param mov The move to check (a mets::swap_elements or a
+    /// mets::invert_subsequence)
+    bool is_tabu(const feasible_solution &sol, const move &mov) const {
+        if (const swap_elements *swap = dynamic_cast<const swap_elements *>(&mov))
+            return is_tabu(sol, *swap);
+        return is_tabu(sol, dynamic_cast<const invert_subsequence &>(mov));
+    }
+
+    /// @brief Statically typed (non virtual) version of is_tabu().
+    bool is_tabu(const feasible_solution &sol, const swap_elements &mov) const {
+        if (forbidden(static_cast<const permutation_problem &>(sol), mov.first(), mov.second()))
+            return true;
+        return tabu_list_chain::is_tabu(sol, mov);
+    }
+
+    /// @brief Statically typed (non virtual) version of is_tabu().
+    bool is_tabu(const feasible_solution &sol, const invert_subsequence &mov) const {
+        if (forbidden(static_cast<const permutation_problem &>(sol), mov.first(), mov.second()))
+            return true;
+        return tabu_list_chain::is_tabu(sol, mov);
+    }
+
+    /// @brief The minimum tenure.
+    unsigned int min_tenure() const { return tmin_m; }
+
+    /// @brief The maximum tenure.
+    unsigned int tenure() const { return tabu_list_chain::tenure(); }
+
+    /// @brief Changes the maximum tenure, scaling the minimum one by
+    /// the same factor.
+    ///
+    /// The minimum tenure keeps the ratio given at construction: it
+    /// does not drift when the tenure goes up and down.
+    void tenure(unsigned int tmax) {
+        tmin_m = base_tmax_m ? static_cast<unsigned int>(
+                                       static_cast<unsigned long long>(base_tmin_m) * tmax /
+                                       base_tmax_m)
+                             : tmax;
+        tabu_list_chain::tenure(tmax);
+    }
+
+  protected:
+    /// @brief Forbids the elements at p1 and p2 to go back.
+    void tabu_positions(const permutation_problem &sol, int p1, int p2);
+
+    /// @brief True if the elements at p1 and p2 can not be swapped.
+    bool forbidden(const permutation_problem &sol, int p1, int p2) const {
+        return until_m[size_t(sol.pi(p2)) * size_m + p1] > clock_m &&
+               until_m[size_t(sol.pi(p1)) * size_m + p2] > clock_m;
+    }
+
+    /// @brief A random tenure in [min_tenure(), tenure()].
+    unsigned int draw() {
+        const unsigned int width = tenure() - tmin_m + 1;
+        state_m += 0x9e3779b97f4a7c15ULL;
+        return tmin_m + static_cast<unsigned int>(mix64(state_m) % width);
+    }
+
+    size_t size_m;
+    unsigned int tmin_m;
+    /// @brief The tenures given at construction.
+    unsigned int base_tmin_m;
+    unsigned int base_tmax_m;
+    unsigned long clock_m;
+    unsigned long long state_m;
+    std::vector<unsigned long> until_m;
+};
+
 /// @brief Aspiration criteria implementation.
 ///
 /// This is one of the best known aspiration criteria
@@ -299,58 +789,110 @@ class simple_tabu_list : public tabu_list_chain {
 ///
 /// This aspiration criteria is met when a tabu move would result in
 /// a global improvement.
-class best_ever_criteria : public aspiration_criteria_chain {
+///
+/// The solution_type is the type of the searched solutions (a
+/// mets::evaluable_solution): accept() called with a solution_type
+/// does not need any cast. The mets::best_ever_criteria works with
+/// any mets::evaluable_solution.
+template <typename solution_type>
+class basic_best_ever_criteria : public aspiration_criteria_chain {
   public:
-    explicit best_ever_criteria(double min_improvement = 1e-6);
+    explicit basic_best_ever_criteria(double min_improvement = 1e-6);
 
-    explicit best_ever_criteria(aspiration_criteria_chain *next, double min_improvement = 1e-6);
+    explicit basic_best_ever_criteria(aspiration_criteria_chain *next,
+                                      double min_improvement = 1e-6);
 
     void reset();
 
-    void accept(const feasible_solution &fs, const move &mov, gol_type evaluation);
+    /// @param fs The current working solution (a solution_type).
+    /// @throw std::bad_cast if it is not.
+    void accept(const feasible_solution &fs, const move &mov, gol_type evaluation) {
+        accept(dynamic_cast<const solution_type &>(fs), mov, evaluation);
+    }
+
+    /// @brief Statically typed (non virtual) version of accept().
+    void accept(const solution_type &fs, const move &mov, gol_type evaluation);
 
-    bool operator()(const feasible_solution &fs, const move &mov, gol_type evaluation) const;
+    bool operator()(const feasible_solution &fs, const move &mov, gol_type evaluation) const {
+        return check(fs, mov, evaluation);
+    }
+
+    /// @brief Statically typed (non virtual) version of operator().
+    bool operator()(const solution_type &fs, const move &mov, gol_type evaluation) const {
+        return check(fs, mov, evaluation);
+    }
 
   protected:
+    bool check(const feasible_solution &fs, const move &mov, gol_type evaluation) const;
+
     gol_type best_m;
     gol_type tolerance_m;
 };
 
+/// @brief The best ever aspiration criteria for any
+/// mets::evaluable_solution.
+typedef basic_best_ever_criteria<evaluable_solution> best_ever_criteria;
+
 /// @}
 }  // namespace mets
 
-template <typename move_manager_t>
-mets::tabu_search<move_manager_t>::tabu_search(feasible_solution &starting_solution,
-                                               solution_recorder &best_recorder,
-                                               move_manager_t &move_manager_inst,
-                                               tabu_list_chain &tabus,
-                                               aspiration_criteria_chain &aspiration,
-                                               termination_criteria_chain &termination)
+#define METS_TABU_SEARCH_TEMPLATE_                                                     \
+    template <typename move_manager_t, typename solution_t, typename recorder_t,          \
+              typename tabu_list_t, typename aspiration_t, typename termination_t,      \
+              typename observer_t>
+
+METS_TABU_SEARCH_TEMPLATE_
+mets::tabu_search<move_manager_t, solution_t, recorder_t, tabu_list_t, aspiration_t, termination_t,
+                  observer_t>::tabu_search(solution_t &starting_solution,
+                                           recorder_t &best_recorder,
+                                           move_manager_t &move_manager_inst, tabu_list_t &tabus,
+                                           aspiration_t &aspiration, termination_t &termination)
     : abstract_search<move_manager_t>(starting_solution, best_recorder, move_manager_inst),
+      working_m(starting_solution),
+      recorder_m(best_recorder),
       tabu_list_m(tabus),
       aspiration_criteria_m(aspiration),
       termination_criteria_m(termination) {}
 
-template <typename move_manager_t>
-void mets::tabu_search<move_manager_t>::search() {
+METS_TABU_SEARCH_TEMPLATE_
+void mets::tabu_search<move_manager_t, solution_t, recorder_t, tabu_list_t, aspiration_t,
+                       termination_t, observer_t>::search() {
     typedef abstract_search<move_manager_t> base_t;
-    while (!termination_criteria_m(base_t::working_solution_m)) {
+    search_statistics &stats = base_t::statistics_m;
+    this->start_event();
+    while (!this->stop_requested() && !termination_criteria_m(working_m)) {
+        this->iteration_event(tabu_list_m.tenure());
+        const gol_type current_cost = base_t::event_m.cost;
+
         // call listeners
-        base_t::step_m = base_t::ITERATION_BEGIN;
-        this->notify();
+        this->template notify_step<observer_t>(base_t::ITERATION_BEGIN);
 
-        base_t::moves_m.refresh(base_t::working_solution_m);
+        this->begin_phase(phase_listener::REFRESH);
+        unsigned long long start = stats.start();
+        base_t::moves_m.refresh(working_m);
+        stats.stop(search_statistics::REFRESH_NS, start);
+        this->end_phase(phase_listener::REFRESH);
 
         typename move_manager_t::iterator best_movit = base_t::moves_m.end();
         gol_type best_move_cost = std::numeric_limits<gol_type>::max();
+        long index = 0;
+        long best_index = -1;
+        bool best_tabu = false;
+        unsigned long tabu_hits = 0;
 
+        this->begin_phase(phase_listener::EVALUATE);
         for (typename move_manager_t::iterator movit = base_t::moves_m.begin();
-             movit != base_t::moves_m.end(); ++movit) {
+             movit != base_t::moves_m.end(); ++movit, ++index) {
             // evaluate proposed move
-            gol_type cost = (*movit)->evaluate(base_t::working_solution_m);
+            start = stats.start();
+            gol_type cost = (*movit)->evaluate(working_m);
+            stats.stop(search_statistics::EVALUATE_NS, start);
 
             // save tabu status
-            bool is_tabu = tabu_list_m.is_tabu(base_t::working_solution_m, **movit);
+            start = stats.start();
+            bool is_tabu = tabu_list_m.is_tabu(working_m, **movit);
+            stats.stop(search_statistics::TABU_NS, start);
+            tabu_hits += is_tabu;
 
             // for each non-tabu move record the best one
             if (cost < best_move_cost) {
@@ -359,48 +901,203 @@ void mets::tabu_search<move_manager_t>::search() {
                 // not interesting if this is not a tabu move (and if we
                 // are not improving over other moves)
                 if (is_tabu) {
-                    aspiration_criteria_met =
-                            aspiration_criteria_m(base_t::working_solution_m, **movit, cost);
+                    aspiration_criteria_met = aspiration_criteria_m(working_m, **movit, cost);
                 }
 
                 if (!is_tabu || aspiration_criteria_met) {
                     best_move_cost = cost;
                     best_movit = base_t::current_move_m = movit;
+                    best_index = index;
+                    best_tabu = is_tabu;
                     if (aspiration_criteria_met) {
-                        base_t::step_m = ASPIRATION_CRITERIA_MET;
-                        this->notify();
+                        this->move_event(index, cost, cost - current_cost, true, true);
+                        this->template notify_step<observer_t>(ASPIRATION_CRITERIA_MET);
                     }
                 }
             }
         }  // end for each move
+        this->end_phase(phase_listener::EVALUATE);
+
+        stats.add(search_statistics::REFRESHES, 1);
+        stats.add(search_statistics::MOVES_EVALUATED, index);
+        stats.add(search_statistics::TABU_HITS, tabu_hits);
 
         if (best_movit == base_t::moves_m.end()) throw no_moves_error();
 
         // make move tabu
-        tabu_list_m.tabu(base_t::working_solution_m, **best_movit);
+        start = stats.start();
+        tabu_list_m.tabu(working_m, **best_movit);
+        stats.stop(search_statistics::TABU_NS, start);
 
         // do the best non tabu move (unless overridden by aspiration
         // criteria, of course)
-        (*best_movit)->apply(base_t::working_solution_m);
+        this->begin_phase(phase_listener::APPLY);
+        start = stats.start();
+        (*best_movit)->apply(working_m);
+        stats.stop(search_statistics::APPLY_NS, start);
+        this->end_phase(phase_listener::APPLY);
+        stats.add(search_statistics::MOVES_ACCEPTED, 1);
+        stats.add(search_statistics::ASPIRATION_OVERRIDES, best_tabu);
 
         // call listeners
-        base_t::step_m = base_t::MOVE_MADE;
-        this->notify();
+        this->move_event(best_index, best_move_cost, best_move_cost - current_cost, best_tabu,
+                         best_tabu);
+        this->template notify_step<observer_t>(base_t::MOVE_MADE);
 
-        aspiration_criteria_m.accept(base_t::working_solution_m, **best_movit, best_move_cost);
+        aspiration_criteria_m.accept(working_m, **best_movit, best_move_cost);
 
-        if (base_t::solution_recorder_m.accept(base_t::working_solution_m)) {
-            base_t::step_m = base_t::IMPROVEMENT_MADE;
-            this->notify();
+        if (recorder_m.accept(working_m)) {
+            stats.add(search_statistics::IMPROVEMENTS, 1);
+            this->template notify_step<observer_t>(base_t::IMPROVEMENT_MADE);
         }
 
         // call listeners
-        base_t::step_m = base_t::ITERATION_END;
-        this->notify();
+        this->template notify_step<observer_t>(base_t::ITERATION_END);
 
     }  // end while(!termination)
 }
 
+METS_TABU_SEARCH_TEMPLATE_
+mets::parallel_tabu_search<move_manager_t, solution_t, recorder_t, tabu_list_t, aspiration_t,
+                           termination_t, observer_t>::
+        parallel_tabu_search(solution_t &starting_solution, recorder_t &best_recorder,
+                             move_manager_t &move_manager_inst, tabu_list_t &tabus,
+                             aspiration_t &aspiration, termination_t &termination,
+                             thread_pool &pool)
+    : tabu_search_type(starting_solution, best_recorder, move_manager_inst, tabus, aspiration,
+                       termination),
+      pool_m(pool),
+      candidates_m(),
+      tabu_hits_m() {}
+
+METS_TABU_SEARCH_TEMPLATE_
+void mets::parallel_tabu_search<move_manager_t, solution_t, recorder_t, tabu_list_t, aspiration_t,
+                                termination_t, observer_t>::chunk_evaluation::
+operator()(unsigned int chunk) {
+    const solution_t &working = search_m.working_m;
+    std::vector<candidate> &found = search_m.candidates_m[chunk];
+    found.clear();
+
+    iterator movit = begin_m + size_m * chunk / chunks_m;
+    iterator last = begin_m + size_m * (chunk + 1) / chunks_m;
+    gol_type best_move_cost = std::numeric_limits<gol_type>::max();
+    unsigned long tabu_hits = 0;
+    for (; movit != last; ++movit) {
+        gol_type cost = (*movit)->evaluate(working);
+        bool is_tabu = search_m.tabu_list_m.is_tabu(working, **movit);
+        tabu_hits += is_tabu;
+        if (cost < best_move_cost) {
+            bool aspiration_criteria_met = false;
+            if (is_tabu)
+                aspiration_criteria_met = search_m.aspiration_criteria_m(working, **movit, cost);
+
+            if (!is_tabu || aspiration_criteria_met) {
+                best_move_cost = cost;
+                candidate c = {movit, cost, aspiration_criteria_met};
+                found.push_back(c);
+            }
+        }
+    }
+    search_m.tabu_hits_m[chunk] = tabu_hits;
+}
+
+METS_TABU_SEARCH_TEMPLATE_
+void mets::parallel_tabu_search<move_manager_t, solution_t, recorder_t, tabu_list_t, aspiration_t,
+                                termination_t, observer_t>::search() {
+    typedef abstract_search<move_manager_t> base_t;
+    typedef tabu_search_type tabu_t;
+    search_statistics &stats = base_t::statistics_m;
+    candidates_m.resize(pool_m.size());
+    tabu_hits_m.resize(pool_m.size());
+
+    this->start_event();
+    while (!this->stop_requested() && !tabu_t::termination_criteria_m(tabu_t::working_m)) {
+        this->iteration_event(tabu_t::tabu_list_m.tenure());
+        const gol_type current_cost = base_t::event_m.cost;
+
+        // call listeners
+        this->template notify_step<observer_t>(base_t::ITERATION_BEGIN);
+
+        this->begin_phase(phase_listener::REFRESH);
+        unsigned long long start = stats.start();
+        base_t::moves_m.refresh(tabu_t::working_m);
+        stats.stop(search_statistics::REFRESH_NS, start);
+        this->end_phase(phase_listener::REFRESH);
+
+        iterator best_movit = base_t::moves_m.end();
+        gol_type best_move_cost = std::numeric_limits<gol_type>::max();
+        bool best_aspiration = false;
+
+        const long size = std::distance(base_t::moves_m.begin(), base_t::moves_m.end());
+        chunk_evaluation evaluation(*this, base_t::moves_m.begin(), size, candidates_m.size());
+        this->begin_phase(phase_listener::EVALUATE);
+        start = stats.start();
+        pool_m.run(candidates_m.size(), evaluation);
+        stats.stop(search_statistics::EVALUATE_NS, start);
+        this->end_phase(phase_listener::EVALUATE);
+
+        stats.add(search_statistics::REFRESHES, 1);
+        stats.add(search_statistics::MOVES_EVALUATED, size);
+        for (unsigned int chunk = 0; chunk != tabu_hits_m.size(); ++chunk)
+            stats.add(search_statistics::TABU_HITS, tabu_hits_m[chunk]);
+
+        // merge the chunks in neighborhood order: a candidate is the
+        // best move so far only if it improves over the previous
+        // chunks as well, exactly as in the serial scan.
+        for (unsigned int chunk = 0; chunk != candidates_m.size(); ++chunk) {
+            const std::vector<candidate> &found = candidates_m[chunk];
+            for (typename std::vector<candidate>::const_iterator c = found.begin();
+                 c != found.end(); ++c) {
+                if (c->cost < best_move_cost) {
+                    best_move_cost = c->cost;
+                    best_movit = base_t::current_move_m = c->movit;
+                    best_aspiration = c->aspiration;
+                    if (c->aspiration) {
+                        this->move_event(c->movit - base_t::moves_m.begin(), c->cost,
+                                         c->cost - current_cost, true, true);
+                        this->template notify_step<observer_t>(tabu_t::ASPIRATION_CRITERIA_MET);
+                    }
+                }
+            }
+        }
+
+        if (best_movit == base_t::moves_m.end()) throw no_moves_error();
+
+        // make move tabu
+        start = stats.start();
+        tabu_t::tabu_list_m.tabu(tabu_t::working_m, **best_movit);
+        stats.stop(search_statistics::TABU_NS, start);
+
+        // do the best non tabu move (unless overridden by aspiration
+        // criteria, of course)
+        this->begin_phase(phase_listener::APPLY);
+        start = stats.start();
+        (*best_movit)->apply(tabu_t::working_m);
+        stats.stop(search_statistics::APPLY_NS, start);
+        this->end_phase(phase_listener::APPLY);
+        stats.add(search_statistics::MOVES_ACCEPTED, 1);
+        stats.add(search_statistics::ASPIRATION_OVERRIDES, best_aspiration);
+
+        // call listeners
+        this->move_event(best_movit - base_t::moves_m.begin(), best_move_cost,
+                         best_move_cost - current_cost, best_aspiration, best_aspiration);
+        this->template notify_step<observer_t>(base_t::MOVE_MADE);
+
+        tabu_t::aspiration_criteria_m.accept(tabu_t::working_m, **best_movit, best_move_cost);
+
+        if (tabu_t::recorder_m.accept(tabu_t::working_m)) {
+            stats.add(search_statistics::IMPROVEMENTS, 1);
+            this->template notify_step<observer_t>(base_t::IMPROVEMENT_MADE);
+        }
+
+        // call listeners
+        this->template notify_step<observer_t>(base_t::ITERATION_END);
+
+    }  // end while(!termination)
+}
+
+#undef METS_TABU_SEARCH_TEMPLATE_
+
 // chain of responsibility
 
 inline void mets::tabu_list_chain::tabu(const feasible_solution &sol, const move &mov) {
@@ -416,21 +1113,26 @@ inline bool mets::tabu_list_chain::is_tabu(const feasible_solution &sol, const m
 
 inline mets::simple_tabu_list::~simple_tabu_list() {
     for (move_map_type::iterator m = tabu_hash_m.begin(); m != tabu_hash_m.end(); ++m)
-        delete m->first;
+        release(m->first, m->second.pooled);
 }
 
-inline void mets::simple_tabu_list::tabu(const feasible_solution &sol, const move &mov) {
-    const mana_move *mc = dynamic_cast<const mana_move &>(mov).opposite_of();
+inline void mets::simple_tabu_list::tabu(const feasible_solution &sol, const mana_move &mov) {
+    tabu_entry entry = {1, true};
+    const mana_move *mc = mov.opposite_in(pool_m);
+    if (!mc) {
+        entry.pooled = false;
+        mc = mov.opposite_of();
+    }
 
     // This does nothing if the move was already tabu (can happen when
     // aspiration criteria is met).
     std::pair<move_map_type::iterator, bool> insert_result =
-            tabu_hash_m.insert(std::make_pair(mc, 1));
+            tabu_hash_m.insert(std::make_pair(mc, entry));
 
     // If it was already in the map, increase the counter
     if (!insert_result.second) {
-        insert_result.first->second++;
-        delete mc;
+        insert_result.first->second.count++;
+        release(mc, entry.pooled);
         mc = insert_result.first->first;
     }
     // Always add the move at the end of the list (when aspiration
@@ -444,29 +1146,127 @@ inline void mets::simple_tabu_list::tabu(const feasible_solution &sol, const mov
     // elements)
     while (tabu_hash_m.size() > this->tenure()) {
         // update hash map *and* list structures
-        move_map_type::iterator elem =
-                tabu_hash_m.find(dynamic_cast<const mana_move *>(tabu_moves_m.front()));
-        elem->second--;
-        if (elem->second == 0) {
+        move_map_type::iterator elem = tabu_hash_m.find(tabu_moves_m.front());
+        elem->second.count--;
+        if (elem->second.count == 0) {
             const mana_move *tmp = elem->first;
+            const bool pooled = elem->second.pooled;
             tabu_hash_m.erase(elem);
-            delete tmp;
+            release(tmp, pooled);
         }
         tabu_moves_m.pop_front();
     }
     tabu_list_chain::tabu(sol, mov);
 }
 
-inline bool mets::simple_tabu_list::is_tabu(const feasible_solution &sol, const move &mov) const {
+inline bool mets::simple_tabu_list::is_tabu(const feasible_solution &sol,
+                                            const mana_move &mov) const {
     // hash set. very fast but requires C++ ISO TR1 extension
     // and an hash function in every move (Omega(1)).
-    bool tabu = (tabu_hash_m.find(&dynamic_cast<const mana_move &>(mov)) != tabu_hash_m.end());
+    bool tabu = (tabu_hash_m.find(&mov) != tabu_hash_m.end());
 
     if (tabu) return true;
 
     return tabu_list_chain::is_tabu(sol, mov);
 }
 
+inline void mets::flat_tabu_list::tabu(const feasible_solution &sol, const mana_move &mov) {
+    const move_key key = mov.opposite_key();
+    slot &entry = table_m[find(key)];
+    if (entry.count == 0) {
+        entry.key = key;
+        ++distinct_m;
+    }
+    ++entry.count;
+    push(key);
+
+    // as in the simple_tabu_list the tenure is the number of
+    // different moves in the queue
+    while (distinct_m > this->tenure()) {
+        const size_t ii = find(queue_m[head_m]);
+        head_m = (head_m + 1) & (queue_m.size() - 1);
+        --queued_m;
+        if (--table_m[ii].count == 0) {
+            erase(ii);
+            --distinct_m;
+        }
+    }
+    tabu_list_chain::tabu(sol, mov);
+}
+
+inline void mets::flat_tabu_list::erase(size_t hole) {
+    // backward shift deletion: move back each following key that
+    // can reach the hole from its home slot (no tombstones)
+    for (size_t ii = (hole + 1) & mask_m; table_m[ii].count; ii = (ii + 1) & mask_m) {
+        const size_t home = static_cast<size_t>(table_m[ii].key.hash()) & mask_m;
+        if (((ii - home) & mask_m) >= ((ii - hole) & mask_m)) {
+            table_m[hole] = table_m[ii];
+            hole = ii;
+        }
+    }
+    table_m[hole].count = 0;
+}
+
+inline void mets::flat_tabu_list::reserve(unsigned int tenure) {
+    size_t capacity = 16;
+    while (capacity < 2 * (static_cast<size_t>(tenure) + 1)) capacity *= 2;
+    if (capacity <= table_m.size()) return;
+
+    std::vector<slot> old(capacity, slot());
+    old.swap(table_m);
+    mask_m = capacity - 1;
+    for (size_t ii = 0; ii != old.size(); ++ii)
+        if (old[ii].count) table_m[find(old[ii].key)] = old[ii];
+}
+
+inline void mets::flat_tabu_list::push(const move_key &key) {
+    if (queued_m == queue_m.size()) {
+        // the queue is longer than the tenure only when tabu moves
+        // are made again (e.g. by aspiration), grow it in order
+        std::vector<move_key> grown(std::max(size_t(16), 2 * queue_m.size()));
+        for (size_t ii = 0; ii != queued_m; ++ii)
+            grown[ii] = queue_m[(head_m + ii) & (queue_m.size() - 1)];
+        queue_m.swap(grown);
+        head_m = 0;
+    }
+    queue_m[(head_m + queued_m) & (queue_m.size() - 1)] = key;
+    ++queued_m;
+}
+
+inline void mets::element_position_tabu_list::tabu_positions(const permutation_problem &sol,
+                                                              int p1, int p2) {
+    ++clock_m;
+    until_m[size_t(sol.pi(p1)) * size_m + p1] = clock_m + draw();
+    until_m[size_t(sol.pi(p2)) * size_m + p2] = clock_m + draw();
+}
+
+inline void mets::swap_tabu_matrix::tabu(const feasible_solution &sol, const swap_elements &mov) {
+    const size_t ii = index(mov);
+    if (tabu_m[ii]) {
+        unlink(ii);
+    } else {
+        tabu_m[ii] = true;
+        ++count_m;
+    }
+    append(ii);
+    // the least recent moves in excess expire
+    const size_t head = links_m.size() - 1;
+    while (count_m > this->tenure()) {
+        const size_t oldest = links_m[head].next;
+        unlink(oldest);
+        tabu_m[oldest] = false;
+        --count_m;
+    }
+    tabu_list_chain::tabu(sol, mov);
+}
+
+inline bool mets::swap_tabu_matrix::is_tabu(const feasible_solution &sol,
+                                            const swap_elements &mov) const {
+    if (tabu_m[index(mov)]) return true;
+
+    return tabu_list_chain::is_tabu(sol, mov);
+}
+
 //////////////////////////////////////////////////////////////////////////
 // aspiration_criteria_chain
 inline void mets::aspiration_criteria_chain::reset() {
@@ -488,30 +1288,35 @@ inline bool mets::aspiration_criteria_chain::operator()(const feasible_solution
 
 //////////////////////////////////////////////////////////////////////////
 // best_ever_criteria
-inline mets::best_ever_criteria::best_ever_criteria(double tolerance)
+template <typename solution_type>
+mets::basic_best_ever_criteria<solution_type>::basic_best_ever_criteria(double tolerance)
     : aspiration_criteria_chain(),
       best_m(std::numeric_limits<gol_type>::max()),
       tolerance_m(tolerance) {}
 
-inline mets::best_ever_criteria::best_ever_criteria(aspiration_criteria_chain *next,
-                                                    double tolerance)
+template <typename solution_type>
+mets::basic_best_ever_criteria<solution_type>::basic_best_ever_criteria(
+        aspiration_criteria_chain *next, double tolerance)
     : aspiration_criteria_chain(next),
       best_m(std::numeric_limits<gol_type>::max()),
       tolerance_m(tolerance) {}
 
-inline void mets::best_ever_criteria::reset() {
+template <typename solution_type>
+void mets::basic_best_ever_criteria<solution_type>::reset() {
     best_m = std::numeric_limits<mets::gol_type>::max();
     aspiration_criteria_chain::reset();
 }
 
-inline void mets::best_ever_criteria::accept(const feasible_solution &fs, const move &mov,
-                                             gol_type eval) {
-    best_m = std::min(dynamic_cast<const evaluable_solution &>(fs).cost_function(), best_m);
+template <typename solution_type>
+void mets::basic_best_ever_criteria<solution_type>::accept(const solution_type &fs,
+                                                           const move &mov, gol_type eval) {
+    best_m = std::min(fs.cost_function(), best_m);
     aspiration_criteria_chain::accept(fs, mov, eval);
 }
 
-inline bool mets::best_ever_criteria::operator()(const feasible_solution &fs, const move &mov,
-                                                 gol_type eval) const {
+template <typename solution_type>
+bool mets::basic_best_ever_criteria<solution_type>::check(const feasible_solution &fs,
+                                                          const move &mov, gol_type eval) const {
     /// the solution is the solution before applying mov.
     if (eval < best_m - tolerance_m)
         return true;
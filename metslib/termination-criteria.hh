@@ -98,9 +98,17 @@ class iteration_termination_criteria : public termination_criteria_chain {
 /// This termination criteria terminates the tabu-search
 /// after "max" number of itarations without a single
 /// global improvement.
-class noimprove_termination_criteria : public termination_criteria_chain {
+///
+/// The solution_type is the type of the searched solutions: when
+/// called with a solution_type the criterion uses its cost_function()
+/// without any cast (this is what happens when a search is
+/// instantiated on the concrete solution and criterion types). The
+/// mets::noimprove_termination_criteria works with any
+/// mets::evaluable_solution.
+template <typename solution_type>
+class basic_noimprove_termination_criteria : public termination_criteria_chain {
   public:
-    noimprove_termination_criteria(int max, gol_type epsilon = 1e-7)
+    basic_noimprove_termination_criteria(int max, gol_type epsilon = 1e-7)
         : termination_criteria_chain(),
           best_cost_m(std::numeric_limits<gol_type>::max()),
           max_noimprove_m(max),
@@ -110,8 +118,8 @@ class noimprove_termination_criteria : public termination_criteria_chain {
           second_guess_m(0),
           epsilon_m(epsilon) {}
 
-    noimprove_termination_criteria(termination_criteria_chain *next, int max,
-                                   gol_type epsilon = 1e-7)
+    basic_noimprove_termination_criteria(termination_criteria_chain *next, int max,
+                                         gol_type epsilon = 1e-7)
         : termination_criteria_chain(next),
           best_cost_m(std::numeric_limits<gol_type>::max()),
           max_noimprove_m(max),
@@ -121,7 +129,15 @@ class noimprove_termination_criteria : public termination_criteria_chain {
           second_guess_m(0),
           epsilon_m(epsilon) {}
 
-    bool operator()(const feasible_solution &fs);
+    /// @param fs The current working solution (a solution_type).
+    /// @throw std::bad_cast if it is not.
+    bool operator()(const feasible_solution &fs) {
+        return operator()(dynamic_cast<const solution_type &>(fs));
+    }
+
+    /// @brief Statically typed version of the criterion.
+    bool operator()(const solution_type &fs);
+
     void reset() {
         iterations_left_m = max_noimprove_m;
         second_guess_m = total_iterations_m = resets_m = 0;
@@ -143,21 +159,36 @@ class noimprove_termination_criteria : public termination_criteria_chain {
     gol_type epsilon_m;
 };
 
+/// @brief Termination criteria based on the number of iterations
+/// without an improvement, for any mets::evaluable_solution.
+typedef basic_noimprove_termination_criteria<evaluable_solution> noimprove_termination_criteria;
+
 /// @brief Termination criteria based on cost value
 ///
 /// This termination criteria terminates the tabu-search
 /// when a certain threshold is reached
-class threshold_termination_criteria : public termination_criteria_chain {
+///
+/// @see mets::basic_noimprove_termination_criteria for the meaning
+/// of solution_type.
+template <typename solution_type>
+class basic_threshold_termination_criteria : public termination_criteria_chain {
   public:
-    threshold_termination_criteria(gol_type level, gol_type epsilon = 1e-7)
+    basic_threshold_termination_criteria(gol_type level, gol_type epsilon = 1e-7)
         : termination_criteria_chain(), level_m(level), epsilon_m(epsilon) {}
 
-    threshold_termination_criteria(termination_criteria_chain *next, gol_type level,
-                                   gol_type epsilon = 1e-7)
+    basic_threshold_termination_criteria(termination_criteria_chain *next, gol_type level,
+                                         gol_type epsilon = 1e-7)
         : termination_criteria_chain(next), level_m(level), epsilon_m(epsilon) {}
 
+    /// @param fs The current working solution (a solution_type).
+    /// @throw std::bad_cast if it is not.
     bool operator()(const feasible_solution &fs) {
-        mets::gol_type current_cost = dynamic_cast<const evaluable_solution &>(fs).cost_function();
+        return operator()(dynamic_cast<const solution_type &>(fs));
+    }
+
+    /// @brief Statically typed version of the criterion.
+    bool operator()(const solution_type &fs) {
+        mets::gol_type current_cost = fs.cost_function();
 
         if (current_cost < level_m + epsilon_m) return true;
 
@@ -171,6 +202,88 @@ class threshold_termination_criteria : public termination_criteria_chain {
     gol_type epsilon_m;
 };
 
+/// @brief Termination criteria based on cost value, for any
+/// mets::evaluable_solution.
+typedef basic_threshold_termination_criteria<evaluable_solution> threshold_termination_criteria;
+
+/// @brief A clock measuring the processor time used by the process
+/// (std::clock), usable as a std::chrono clock.
+struct cpu_clock {
+    typedef std::chrono::duration<double> duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<cpu_clock, duration> time_point;
+    static const bool is_steady = true;
+
+    static time_point now() {
+        return time_point(duration(static_cast<double>(std::clock()) / CLOCKS_PER_SEC));
+    }
+};
+
+/// @brief Termination criteria based on a time budget.
+///
+/// This termination criteria terminates the search when the given
+/// amount of time, measured by clock_type, has elapsed since the
+/// first check (after construction or reset()).
+///
+/// Reading the clock can be expensive compared to a fast search
+/// iteration, so the clock is read only every check_interval()
+/// calls. The interval is adapted at each reading from the measured
+/// iteration cost, so that the time spent reading the clock stays
+/// under 1% of the search time. The interval at most doubles at each
+/// reading and never exceeds the number of iterations left before
+/// the deadline (at the iteration cost measured so far), so that
+/// the deadline is not overrun by slow iterations.
+///
+/// @see mets::deadline_termination_criteria
+/// @see mets::cpu_time_termination_criteria
+template <typename clock_type>
+class time_termination_criteria : public termination_criteria_chain {
+  public:
+    typedef typename clock_type::duration duration;
+    typedef typename clock_type::time_point time_point;
+
+    /// @brief Ctor. Budget is the time allowed to the search.
+    explicit time_termination_criteria(duration budget);
+
+    time_termination_criteria(termination_criteria_chain *next, duration budget);
+
+    bool operator()(const feasible_solution &fs);
+
+    void reset();
+
+    /// @brief The time allowed to the search.
+    duration budget() const { return budget_m; }
+
+    /// @brief Number of calls between two clock readings.
+    unsigned long check_interval() const { return interval_m; }
+
+    /// @brief Number of times the clock was read since the last
+    /// reset().
+    unsigned long clock_reads() const { return reads_m; }
+
+  protected:
+    /// @brief Measures the cost of a clock reading.
+    void calibrate();
+
+    duration budget_m;
+    duration clock_cost_m;
+    time_point deadline_m;
+    time_point last_m;
+    unsigned long interval_m;
+    unsigned long countdown_m;
+    unsigned long reads_m;
+    bool expired_m;
+};
+
+/// @brief Termination criteria based on the elapsed (wall clock)
+/// time.
+typedef time_termination_criteria<std::chrono::steady_clock> deadline_termination_criteria;
+
+/// @brief Termination criteria based on the processor time used by
+/// the process.
+typedef time_termination_criteria<cpu_clock> cpu_time_termination_criteria;
+
 /// The mets::forever termination criterion will never terminate the
 /// search.
 ///
@@ -188,6 +301,110 @@ class forever : public termination_criteria_chain {
     void reset() { termination_criteria_chain::reset(); }
 };
 
+/// @brief Compile time conjunction of termination criteria.
+///
+/// The criteria (e.g. mets::iteration_termination_criteria,
+/// mets::noimprove_termination_criteria, ...) are stored by value
+/// and are called directly, without any virtual dispatch: the object
+/// can be used as the termination_type of the search algorithms
+/// (e.g. mets::tabu_search). The search terminates when all the
+/// criteria are met, every criterion is checked at each iteration.
+///
+/// The criteria must not be chained to other criteria, use a
+/// mets::termination_criteria_adapter to chain a composition or to
+/// pass it where a mets::termination_criteria_chain is needed.
+///
+/// @see mets::termination_any
+template <typename... criteria_types>
+class termination_all {
+  public:
+    /// @brief Constructs each criterion from the corresponding
+    /// argument (e.g. the maximum number of iterations).
+    template <typename... arg_types>
+    explicit termination_all(arg_types &&...args) : criteria_m(std::forward<arg_types>(args)...) {}
+
+    /// purposely not implemented (see Effective C++)
+    termination_all(const termination_all &);
+    termination_all &operator=(const termination_all &);
+
+    /// @brief True if all the criteria are met.
+    template <typename solution_type>
+    bool operator()(const solution_type &fs) {
+        bool met = true;
+        std::apply([&fs, &met](auto &...c) { ((met = check(c, fs) && met), ...); }, criteria_m);
+        return met;
+    }
+
+    /// @brief Resets all the criteria.
+    void reset() {
+        std::apply([](auto &...c) { (c.reset(), ...); }, criteria_m);
+    }
+
+    /// @brief The index-th criterion.
+    template <std::size_t index>
+    typename std::tuple_element<index, std::tuple<criteria_types...> >::type &get() {
+        return std::get<index>(criteria_m);
+    }
+
+  protected:
+    template <typename criteria_type, typename solution_type>
+    static bool check(criteria_type &c, const solution_type &fs) {
+        return c.criteria_type::operator()(fs);
+    }
+
+    std::tuple<criteria_types...> criteria_m;
+};
+
+/// @brief Compile time disjunction of termination criteria.
+///
+/// Same as mets::termination_all, but the search terminates as soon
+/// as one of the criteria is met: the criteria are checked in order
+/// and the ones following a met criterion are not called, as in a
+/// mets::termination_criteria_chain.
+template <typename... criteria_types>
+class termination_any : public termination_all<criteria_types...> {
+  public:
+    template <typename... arg_types>
+    explicit termination_any(arg_types &&...args)
+        : termination_all<criteria_types...>(std::forward<arg_types>(args)...) {}
+
+    /// @brief True if one of the criteria is met.
+    template <typename solution_type>
+    bool operator()(const solution_type &fs) {
+        return std::apply(
+                [&fs](auto &...c) { return (termination_any::check(c, fs) || ... || false); },
+                this->criteria_m);
+    }
+};
+
+/// @brief Adapts a statically composed termination criteria
+/// (e.g. mets::termination_any) to the
+/// mets::termination_criteria_chain interface.
+///
+/// The adapted criteria is held by reference.
+template <typename criteria_type>
+class termination_criteria_adapter : public termination_criteria_chain {
+  public:
+    explicit termination_criteria_adapter(criteria_type &criteria)
+        : termination_criteria_chain(), criteria_m(criteria) {}
+
+    termination_criteria_adapter(termination_criteria_chain *next, criteria_type &criteria)
+        : termination_criteria_chain(next), criteria_m(criteria) {}
+
+    bool operator()(const feasible_solution &fs) {
+        if (criteria_m(fs)) return true;
+        return termination_criteria_chain::operator()(fs);
+    }
+
+    void reset() {
+        criteria_m.reset();
+        termination_criteria_chain::reset();
+    }
+
+  protected:
+    criteria_type &criteria_m;
+};
+
 /// @}
 }  // namespace mets
 
@@ -205,8 +422,88 @@ inline void mets::termination_criteria_chain::reset() {
 }
 
 //________________________________________________________________________
-inline bool mets::noimprove_termination_criteria::operator()(const feasible_solution &fs) {
-    mets::gol_type current_cost = dynamic_cast<const evaluable_solution &>(fs).cost_function();
+template <typename clock_type>
+mets::time_termination_criteria<clock_type>::time_termination_criteria(duration budget)
+    : termination_criteria_chain(),
+      budget_m(budget),
+      clock_cost_m(),
+      deadline_m(),
+      last_m(),
+      interval_m(1),
+      countdown_m(1),
+      reads_m(0),
+      expired_m(false) {
+    calibrate();
+}
+
+template <typename clock_type>
+mets::time_termination_criteria<clock_type>::time_termination_criteria(
+        termination_criteria_chain *next, duration budget)
+    : termination_criteria_chain(next),
+      budget_m(budget),
+      clock_cost_m(),
+      deadline_m(),
+      last_m(),
+      interval_m(1),
+      countdown_m(1),
+      reads_m(0),
+      expired_m(false) {
+    calibrate();
+}
+
+template <typename clock_type>
+void mets::time_termination_criteria<clock_type>::calibrate() {
+    const int samples = 16;
+    time_point start = clock_type::now();
+    for (int ii = 1; ii != samples; ++ii) clock_type::now();
+    clock_cost_m = (clock_type::now() - start) / samples;
+}
+
+template <typename clock_type>
+bool mets::time_termination_criteria<clock_type>::operator()(const feasible_solution &fs) {
+    if (expired_m) return true;
+    if (--countdown_m != 0) return termination_criteria_chain::operator()(fs);
+
+    time_point now = clock_type::now();
+    if (reads_m++ == 0) {
+        // first check: the budget starts now
+        deadline_m = now + budget_m;
+    } else {
+        if (now >= deadline_m) {
+            expired_m = true;
+            return true;
+        }
+
+        // iterations needed to spend 100 times the cost of a clock
+        // reading, and iterations left before the deadline
+        double iteration = std::chrono::duration<double>(now - last_m).count() / interval_m;
+        double target = 100 * std::chrono::duration<double>(clock_cost_m).count();
+        double left = std::chrono::duration<double>(deadline_m - now).count();
+        double next = 2.0 * interval_m;
+        if (iteration > 0) {
+            if (target > 0) next = std::min(next, target / iteration);
+            next = std::min(next, left / iteration);
+        }
+        interval_m = next < 1 ? 1 : static_cast<unsigned long>(next);
+    }
+    last_m = now;
+    countdown_m = interval_m;
+    return termination_criteria_chain::operator()(fs);
+}
+
+template <typename clock_type>
+void mets::time_termination_criteria<clock_type>::reset() {
+    interval_m = countdown_m = 1;
+    reads_m = 0;
+    expired_m = false;
+    termination_criteria_chain::reset();
+}
+
+//________________________________________________________________________
+template <typename solution_type>
+bool mets::basic_noimprove_termination_criteria<solution_type>::operator()(
+        const solution_type &fs) {
+    mets::gol_type current_cost = fs.cost_function();
     if (current_cost < best_cost_m - epsilon_m) {
         best_cost_m = current_cost;
         second_guess_m = std::max(second_guess_m, (max_noimprove_m - iterations_left_m));
@@ -0,0 +1,179 @@
+// METSlib source file - thread-pool.hh                          -*- C++ -*-
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_THREAD_POOL_HH_
+#define METS_THREAD_POOL_HH_
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <exception>
+#include <condition_variable>
+
+namespace mets {
+
+/// @defgroup common Common components
+/// @{
+
+/// @brief A fixed size pool of worker threads.
+///
+/// The pool runs batches of independent tasks: run() hands out the
+/// task indices [0, tasks) to the workers (the calling thread works
+/// as well) and returns when all of them are done. It is meant to be
+/// shared by the parallel algorithms of the library (e.g.
+/// mets::parallel_tabu_search), so that the threads are created once
+/// and not at every iteration.
+///
+/// Only one batch at a time can be run on a pool: do not call run()
+/// concurrently from different threads.
+class thread_pool {
+  public:
+    /// @brief Creates a pool.
+    ///
+    /// @param threads The number of threads taking part in run(),
+    /// including the calling thread (0 means one per hardware
+    /// thread).
+    explicit thread_pool(unsigned int threads = 0);
+
+    /// purposely not implemented (see Effective C++)
+    thread_pool(const thread_pool &);
+    /// purposely not implemented (see Effective C++)
+    thread_pool &operator=(const thread_pool &);
+
+    /// @brief Stops and joins the workers.
+    ~thread_pool();
+
+    /// @brief Number of threads taking part in run() (including the
+    /// calling one).
+    unsigned int size() const { return workers_m.size() + 1; }
+
+    /// @brief Calls task(ii) for each ii in [0, tasks) and waits for
+    /// all the calls to return.
+    ///
+    /// Tasks are picked up by the threads in increasing order but can
+    /// complete in any order. If a task throws, the first exception is
+    /// rethrown here once the batch is over.
+    template <typename task_type>
+    void run(unsigned int tasks, task_type &task);
+
+  protected:
+    template <typename task_type>
+    static void invoke(void *task, unsigned int index) {
+        (*static_cast<task_type *>(task))(index);
+    }
+
+    void work();
+    void worker();
+
+    std::vector<std::thread> workers_m;
+    std::mutex mutex_m;
+    std::condition_variable start_m;
+    std::condition_variable done_m;
+    unsigned long generation_m;
+    unsigned int busy_m;
+    bool stop_m;
+
+    void (*invoke_m)(void *, unsigned int);
+    void *task_m;
+    unsigned int tasks_m;
+    std::atomic<unsigned int> next_m;
+    std::exception_ptr error_m;
+};
+
+/// @}
+
+}  // namespace mets
+
+inline mets::thread_pool::thread_pool(unsigned int threads)
+    : workers_m(),
+      mutex_m(),
+      start_m(),
+      done_m(),
+      generation_m(0),
+      busy_m(0),
+      stop_m(false),
+      invoke_m(0),
+      task_m(0),
+      tasks_m(0),
+      next_m(0),
+      error_m() {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    workers_m.reserve(threads - 1);
+    for (unsigned int ii = 1; ii < threads; ++ii)
+        workers_m.push_back(std::thread(&thread_pool::worker, this));
+}
+
+inline mets::thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_m);
+        stop_m = true;
+    }
+    start_m.notify_all();
+    for (std::vector<std::thread>::iterator it = workers_m.begin(); it != workers_m.end(); ++it)
+        it->join();
+}
+
+template <typename task_type>
+void mets::thread_pool::run(unsigned int tasks, task_type &task) {
+    if (tasks == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_m);
+        invoke_m = &thread_pool::invoke<task_type>;
+        task_m = &task;
+        tasks_m = tasks;
+        next_m.store(0);
+        error_m = std::exception_ptr();
+        busy_m = workers_m.size();
+        ++generation_m;
+    }
+    start_m.notify_all();
+    work();
+
+    std::unique_lock<std::mutex> lock(mutex_m);
+    while (busy_m != 0) done_m.wait(lock);
+    if (error_m) std::rethrow_exception(error_m);
+}
+
+inline void mets::thread_pool::work() {
+    for (unsigned int ii = next_m.fetch_add(1); ii < tasks_m; ii = next_m.fetch_add(1)) {
+        try {
+            invoke_m(task_m, ii);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_m);
+            if (!error_m) error_m = std::current_exception();
+        }
+    }
+}
+
+inline void mets::thread_pool::worker() {
+    unsigned long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_m);
+            while (!stop_m && generation_m == seen) start_m.wait(lock);
+            if (stop_m) return;
+            seen = generation_m;
+        }
+        work();
+        std::lock_guard<std::mutex> lock(mutex_m);
+        if (--busy_m == 0) done_m.notify_one();
+    }
+}
+
+#endif
@@ -0,0 +1,343 @@
+// METSlib source file - trace.hh                                -*- C++ -*-
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// This program can be distributed, at your option, under the terms of
+// the CPL 1.0 as published by the Open Source Initiative
+// http://www.opensource.org/licenses/cpl1.0.php
+
+#ifndef METS_TRACE_HH_
+#define METS_TRACE_HH_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mets {
+
+/// @defgroup trace Search traces
+/// @{
+
+/// @brief A fixed size record of a search trace (see
+/// mets::search_event).
+///
+/// Trace files are made of a 16 bytes header ("METSTRC1", the size
+/// of the records and 4 reserved bytes) followed by the records, as
+/// laid out in memory (native byte order).
+struct trace_record {
+    /// @brief Flags of a tabu move.
+    static constexpr std::uint32_t TABU = 1;
+    /// @brief Flags of a move that met the aspiration criteria.
+    static constexpr std::uint32_t ASPIRATION = 2;
+
+    /// @brief Nanoseconds since the trace was opened.
+    std::uint64_t timestamp;
+    std::uint64_t iteration;
+    double cost;
+    double delta;
+    /// @brief The tenure or the temperature (see
+    /// mets::search_event::parameter).
+    double parameter;
+    std::int64_t move_index;
+    std::int32_t step;
+    std::uint32_t flags;
+};
+
+static_assert(sizeof(trace_record) == 56, "trace_record is not packed");
+
+/// @brief A lock free single producer, single consumer ring of trace
+/// records.
+///
+/// push() is called by one thread (the search), pop() by another one
+/// (the writer): neither of them ever waits for the other.
+class trace_ring {
+  public:
+    /// @brief Creates a ring.
+    ///
+    /// @param capacity The minimum number of records in the ring
+    /// (rounded up to a power of two).
+    explicit trace_ring(size_t capacity);
+
+    /// purposely not implemented (see Effective C++)
+    trace_ring(const trace_ring &);
+    /// purposely not implemented (see Effective C++)
+    trace_ring &operator=(const trace_ring &);
+
+    /// @brief The number of records the ring can hold.
+    size_t capacity() const { return buffer_m.size(); }
+
+    /// @brief Appends a record (producer side).
+    ///
+    /// @return False, discarding the record, if the ring is full.
+    bool push(const trace_record &r);
+
+    /// @brief Removes up to max records from the ring (consumer
+    /// side).
+    ///
+    /// @return The number of records copied to out.
+    size_t pop(trace_record *out, size_t max);
+
+  protected:
+    std::vector<trace_record> buffer_m;
+    size_t mask_m;
+    /// @brief Written by the consumer only.
+    alignas(64) std::atomic<size_t> head_m;
+    /// @brief Written by the producer only.
+    alignas(64) std::atomic<size_t> tail_m;
+};
+
+/// @brief Writes a binary search trace to a file from a background
+/// thread.
+///
+/// write() only copies the record in a mets::trace_ring: the
+/// formatting and the I/O are left to the writer thread, so that a
+/// trace can be kept on in long runs. When the writer cannot keep up
+/// and the ring is full the records are dropped (and counted), the
+/// search is never slowed down.
+///
+/// Only one thread at a time can call write().
+class trace_writer {
+  public:
+    /// @brief Opens the trace file and starts the writer thread.
+    ///
+    /// @param path The trace file (truncated).
+    /// @param capacity The number of records of the ring.
+    explicit trace_writer(const std::string &path, size_t capacity = 65536);
+
+    /// purposely not implemented (see Effective C++)
+    trace_writer(const trace_writer &);
+    /// purposely not implemented (see Effective C++)
+    trace_writer &operator=(const trace_writer &);
+
+    /// @brief Closes the trace (errors are ignored, call close() to
+    /// see them).
+    ~trace_writer();
+
+    /// @brief Nanoseconds since the trace was opened.
+    std::uint64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - start_m)
+                .count();
+    }
+
+    /// @brief Queues a record.
+    ///
+    /// @return False if the record was dropped.
+    bool write(const trace_record &r) {
+        if (ring_m.push(r)) return true;
+        dropped_m.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /// @brief Writes the queued records, stops the writer thread and
+    /// closes the file. Does nothing if already closed.
+    ///
+    /// @throw std::runtime_error if the file could not be written.
+    void close();
+
+    /// @brief Number of records written to the file so far.
+    unsigned long written() const { return written_m.load(std::memory_order_relaxed); }
+
+    /// @brief Number of records dropped because the ring was full.
+    unsigned long dropped() const { return dropped_m.load(std::memory_order_relaxed); }
+
+  protected:
+    /// @brief The writer thread.
+    void drain();
+
+    std::ofstream file_m;
+    trace_ring ring_m;
+    std::chrono::steady_clock::time_point start_m;
+    std::atomic<bool> stop_m;
+    std::atomic<unsigned long> written_m;
+    std::atomic<unsigned long> dropped_m;
+    std::thread thread_m;
+};
+
+/// @brief Records the steps of a search in a mets::trace_writer.
+///
+/// Each notified step becomes a record, filled from
+/// mets::abstract_search::event(): attach the listener with a mask
+/// (e.g. <code>search.attach(tracer,
+/// search.step_mask(search.MOVE_MADE))</code>) to trace some of the
+/// steps only.
+template <typename move_manager_type>
+class trace_listener : public search_listener<move_manager_type> {
+  public:
+    typedef abstract_search<move_manager_type> search_type;
+
+    /// @brief Creates a listener writing to the given trace.
+    explicit trace_listener(trace_writer &writer)
+        : search_listener<move_manager_type>(), writer_m(writer) {}
+
+    void update(search_type *search) {
+        const search_event &e = search->event();
+        trace_record r;
+        r.timestamp = writer_m.now();
+        r.iteration = e.iteration;
+        r.cost = e.cost;
+        r.delta = e.delta;
+        r.parameter = e.parameter;
+        r.move_index = e.move_index;
+        r.step = e.step;
+        r.flags = (e.tabu ? trace_record::TABU : 0) |
+                  (e.aspiration ? trace_record::ASPIRATION : 0);
+        writer_m.write(r);
+    }
+
+  protected:
+    trace_writer &writer_m;
+};
+
+/// @brief Reads a trace file written by a mets::trace_writer.
+///
+/// @throw std::runtime_error if the stream is not a trace.
+void read_trace(std::istream &is, std::vector<trace_record> &records);
+
+/// @brief Writes the records as CSV, with a header line.
+void write_trace_csv(std::ostream &os, const std::vector<trace_record> &records);
+
+/// @brief Writes the records in the Chrome trace event format (JSON,
+/// to be loaded in chrome://tracing or Perfetto): the cost and the
+/// parameter become two counters.
+void write_chrome_trace(std::ostream &os, const std::vector<trace_record> &records);
+
+/// @}
+}  // namespace mets
+
+inline mets::trace_ring::trace_ring(size_t capacity)
+    : buffer_m(), mask_m(0), head_m(0), tail_m(0) {
+    size_t size = 1;
+    while (size < capacity) size *= 2;
+    buffer_m.resize(size);
+    mask_m = size - 1;
+}
+
+inline bool mets::trace_ring::push(const trace_record &r) {
+    const size_t tail = tail_m.load(std::memory_order_relaxed);
+    if (tail - head_m.load(std::memory_order_acquire) == buffer_m.size()) return false;
+    buffer_m[tail & mask_m] = r;
+    tail_m.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+inline size_t mets::trace_ring::pop(trace_record *out, size_t max) {
+    const size_t head = head_m.load(std::memory_order_relaxed);
+    const size_t n = std::min(max, tail_m.load(std::memory_order_acquire) - head);
+    for (size_t ii = 0; ii != n; ++ii) out[ii] = buffer_m[(head + ii) & mask_m];
+    head_m.store(head + n, std::memory_order_release);
+    return n;
+}
+
+inline mets::trace_writer::trace_writer(const std::string &path, size_t capacity)
+    : file_m(path.c_str(), std::ios::binary | std::ios::trunc),
+      ring_m(capacity),
+      start_m(std::chrono::steady_clock::now()),
+      stop_m(false),
+      written_m(0),
+      dropped_m(0),
+      thread_m() {
+    if (!file_m) throw std::runtime_error("Unable to open trace file " + path);
+    char header[16] = {'M', 'E', 'T', 'S', 'T', 'R', 'C', '1'};
+    const std::uint32_t size = sizeof(trace_record);
+    std::memcpy(header + 8, &size, sizeof(size));
+    file_m.write(header, sizeof(header));
+    thread_m = std::thread(&trace_writer::drain, this);
+}
+
+inline mets::trace_writer::~trace_writer() {
+    try {
+        close();
+    } catch (const std::runtime_error &) {
+    }
+}
+
+inline void mets::trace_writer::close() {
+    if (!thread_m.joinable()) return;
+    stop_m.store(true);
+    thread_m.join();
+    file_m.close();
+    if (file_m.fail()) throw std::runtime_error("Unable to write trace file");
+}
+
+inline void mets::trace_writer::drain() {
+    std::vector<trace_record> batch(std::min<size_t>(ring_m.capacity(), 4096));
+    for (;;) {
+        // read the flag first: the records queued before the stop are
+        // all in the ring by then
+        const bool stop = stop_m.load();
+        size_t n = ring_m.pop(&batch[0], batch.size());
+        if (n) {
+            file_m.write(reinterpret_cast<const char *>(&batch[0]), n * sizeof(trace_record));
+            written_m.fetch_add(n, std::memory_order_relaxed);
+        } else if (stop) {
+            break;
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    file_m.flush();
+}
+
+inline void mets::read_trace(std::istream &is, std::vector<trace_record> &records) {
+    char header[16];
+    std::uint32_t size = 0;
+    if (is.read(header, sizeof(header))) std::memcpy(&size, header + 8, sizeof(size));
+    if (!is || std::memcmp(header, "METSTRC1", 8) != 0 || size != sizeof(trace_record))
+        throw std::runtime_error("Not a METSlib trace");
+    records.clear();
+    trace_record r;
+    while (is.read(reinterpret_cast<char *>(&r), sizeof(r))) records.push_back(r);
+}
+
+inline void mets::write_trace_csv(std::ostream &os, const std::vector<trace_record> &records) {
+    std::streamsize precision = os.precision(17);
+    os << "timestamp_ns,step,iteration,cost,delta,move_index,parameter,tabu,aspiration\n";
+    for (std::vector<trace_record>::const_iterator r = records.begin(); r != records.end(); ++r)
+        os << r->timestamp << ',' << r->step << ',' << r->iteration << ',' << r->cost << ','
+           << r->delta << ',' << r->move_index << ',' << r->parameter << ','
+           << bool(r->flags & trace_record::TABU) << ','
+           << bool(r->flags & trace_record::ASPIRATION) << '\n';
+    os.precision(precision);
+}
+
+inline void mets::write_chrome_trace(std::ostream &os, const std::vector<trace_record> &records) {
+    std::streamsize precision = os.precision(17);
+    os << "{\"traceEvents\":[";
+    const char *separator = "\n";
+    for (std::vector<trace_record>::const_iterator r = records.begin(); r != records.end(); ++r) {
+        // JSON has no NaN nor infinity: such values are left out
+        const double values[] = {r->cost, r->parameter};
+        const char *names[] = {"cost", "parameter"};
+        for (int ii = 0; ii != 2; ++ii) {
+            if (!std::isfinite(values[ii])) continue;
+            os << separator << "{\"name\":\"" << names[ii]
+               << "\",\"ph\":\"C\",\"pid\":0,\"tid\":0,\"ts\":" << r->timestamp / 1000.0
+               << ",\"args\":{\"" << names[ii] << "\":" << values[ii] << "}}";
+            separator = ",\n";
+        }
+    }
+    os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    os.precision(precision);
+}
+
+#endif
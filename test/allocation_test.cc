@@ -0,0 +1,170 @@
+// allocation regression: the tabu list does not use the global heap
+// once warmed up
+#include <metslib/mets.hh>
+
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+static std::atomic<long> allocations(0);
+
+void *operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t a = static_cast<std::size_t>(alignment);
+    if (void *p = std::aligned_alloc(a, (size + a - 1) / a * a)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+// a user move with the default opposite_of(), cloned with new
+class my_move : public mets::mana_move {
+    int i_m;
+
+  public:
+    my_move(int i) : i_m(i) {}
+
+    bool operator==(const mana_move &m) const {
+        const my_move &o = static_cast<const my_move &>(m);
+        return i_m == o.i_m;
+    }
+
+    my_move *clone() const { return new my_move(i_m); }
+
+    size_t hash() const { return i_m; }
+
+    void apply(mets::feasible_solution &) const {}
+    mets::gol_type evaluate(const mets::feasible_solution &) const { return 0.0; }
+};
+
+// a memory resource counting the bytes it hands out
+class counting_resource : public std::pmr::memory_resource {
+  public:
+    counting_resource() : allocated(0) {}
+    long allocated;
+
+  protected:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) {
+        allocated += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+        return this == &other;
+    }
+};
+
+// makes tabu the moves of a cycle longer than the tenure, with some
+// repeated moves, and checks them; returns the number of tabu moves
+template <typename move_type>
+int tabu_loop(mets::simple_tabu_list &tl, int iterations) {
+    mets::feasible_solution s;
+    int tabu = 0;
+    for (int ii = 0; ii != iterations; ++ii) {
+        move_type m(ii % 37, ii % 37 + 1 + ii % 5);
+        tl.tabu(s, m);
+        if (ii % 3 == 0) tl.tabu(s, m);
+        for (int jj = 0; jj != 10; ++jj) {
+            move_type t(jj, jj + 1 + ii % 5);
+            if (tl.is_tabu(s, t)) ++tabu;
+        }
+    }
+    return tabu;
+}
+
+struct my_pair_move : public my_move {
+    my_pair_move(int i, int j) : my_move(i * 64 + j) {}
+};
+
+// a user move cloned in the pool of the tabu list
+struct my_pooled_move : public my_pair_move {
+    my_pooled_move(int i, int j) : my_pair_move(i, j) {}
+
+    mets::mana_move *opposite_in(std::pmr::memory_resource &resource) const {
+        return create_in(resource, *this);
+    }
+};
+
+int main(void) {
+    // swaps, cloned by the library
+    {
+        mets::simple_tabu_list tl(11);
+        tabu_loop<mets::swap_elements>(tl, 1000);
+        long before = allocations.load();
+        int tabu = tabu_loop<mets::swap_elements>(tl, 100000);
+        if (allocations.load() != before || tabu == 0) {
+            cerr << "Tabu list allocated " << allocations.load() - before << " times." << endl;
+            return 1;
+        }
+    }
+
+    // user moves cloned in the pool
+    {
+        mets::simple_tabu_list tl(11);
+        tabu_loop<my_pooled_move>(tl, 1000);
+        long before = allocations.load();
+        int tabu = tabu_loop<my_pooled_move>(tl, 100000);
+        if (allocations.load() != before || tabu == 0) {
+            cerr << "Tabu list allocated " << allocations.load() - before
+                 << " times with user moves." << endl;
+            return 1;
+        }
+    }
+
+    // the upstream resource is used only while warming up
+    {
+        counting_resource upstream;
+        {
+            mets::simple_tabu_list tl(11, &upstream);
+            tabu_loop<mets::swap_elements>(tl, 1000);
+            long warm = upstream.allocated;
+            tabu_loop<mets::swap_elements>(tl, 100000);
+            if (warm == 0 || upstream.allocated != warm) {
+                cerr << "Tabu list used the upstream resource after warm up." << endl;
+                return 1;
+            }
+        }
+    }
+
+    // user moves without opposite_in() are cloned with new, as the
+    // moves outside of the tabu list
+    {
+        mets::simple_tabu_list tl(11);
+        tabu_loop<my_pair_move>(tl, 1000);
+        long before = allocations.load();
+        int tabu = tabu_loop<my_pair_move>(tl, 1000);
+        if (allocations.load() == before || tabu == 0) {
+            cerr << "User moves not cloned with opposite_of()." << endl;
+            return 1;
+        }
+    }
+    {
+        long before = allocations.load();
+        mets::mana_move *m = new mets::swap_elements(1, 2);
+        mets::clonable *c = m->clone();
+        delete m;
+        delete c;
+        if (allocations.load() != before + 2) {
+            cerr << "Moves not allocated with the global operator new." << endl;
+            return 1;
+        }
+    }
+
+    cerr << "Success!" << endl;
+    return 0;
+}
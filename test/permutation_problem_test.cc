@@ -23,6 +23,53 @@ class p : public mets::permutation_problem {
 
 p::~p() {}
 
+// a small asymmetric QAP with the Taillard incremental delta update
+class qap : public mets::permutation_problem {
+  public:
+    qap(int n) : permutation_problem(n), a_m(n * n), b_m(n * n) {
+        unsigned int seed = 4321;
+        for (int ii = 0; ii != n * n; ++ii) {
+            seed = seed * 1103515245 + 12345;
+            a_m[ii] = (seed >> 16) % 10;
+            seed = seed * 1103515245 + 12345;
+            b_m[ii] = (seed >> 16) % 10;
+        }
+        update_cost();
+    }
+
+    int a(int i, int j) const { return a_m[i * size() + j]; }
+    int b(int i, int j) const { return b_m[pi_m[i] * size() + pi_m[j]]; }
+
+    mets::gol_type compute_cost() const {
+        int n = size();
+        mets::gol_type sum = 0.0;
+        for (int ii = 0; ii != n; ++ii)
+            for (int jj = 0; jj != n; ++jj) sum += a(ii, jj) * b(ii, jj);
+        return sum;
+    }
+
+    mets::gol_type evaluate_swap(int r, int s) const {
+        int n = size();
+        mets::gol_type d = (a(r, r) - a(s, s)) * (b(s, s) - b(r, r)) +
+                           (a(r, s) - a(s, r)) * (b(s, r) - b(r, s));
+        for (int k = 0; k != n; ++k)
+            if (k != r && k != s)
+                d += (a(k, r) - a(k, s)) * (b(k, s) - b(k, r)) +
+                     (a(r, k) - a(s, k)) * (b(s, k) - b(r, k));
+        return d;
+    }
+
+    mets::gol_type update_delta(int i, int j, int r, int s, mets::gol_type delta) const {
+        return delta + (a(r, i) - a(r, j) + a(s, j) - a(s, i)) *
+                               (b(s, i) - b(s, j) + b(r, j) - b(r, i)) +
+               (a(i, r) - a(j, r) + a(j, s) - a(i, s)) * (b(i, s) - b(j, s) + b(j, r) - b(i, r));
+    }
+
+  protected:
+    std::vector<int> a_m;
+    std::vector<int> b_m;
+};
+
 mets::gol_type p::cost_function() const { return 0.0; }
 
 int main() {
@@ -99,6 +146,167 @@ int main() {
         }
     }
 
+    // test the swap delta cache is kept up to date
+    {
+        const int n = 12;
+        qap pi(n);
+        pi.enable_delta_cache();
+        std::minstd_rand0 rng;
+        for (int ii = 0; ii != 50; ++ii) {
+            mets::perturbate(pi, 1, rng);
+            for (int i = 0; i != n; ++i)
+                for (int j = 0; j != n; ++j)
+                    if (i != j && pi.swap_delta(i, j) != pi.evaluate_swap(i, j)) {
+                        cerr << "Failed delta cache at " << i << ", " << j << "." << endl;
+                        return 1;
+                    }
+            if (pi.cost_function() != pi.compute_cost()) {
+                cerr << "Failed delta cache cost." << endl;
+                return 1;
+            }
+        }
+    }
+
+    // test the incremental hash follows the swaps and inversions
+    {
+        const int n = 12;
+        qap pi(n);
+        qap other(n);
+        pi.enable_hash();
+        std::minstd_rand0 rng;
+        for (int ii = 0; ii != 200; ++ii) {
+            int i = rng() % n, j = rng() % n;
+            size_t peek = pi.peek_hash_after_swap(i, j);
+            if (ii % 2) {
+                mets::swap_elements(i, j).apply(pi);
+            } else {
+                mets::invert_subsequence(i, j).apply(pi);
+                peek = pi.hash();
+            }
+            other.copy_from(pi);
+            const mets::hashable &h = pi;
+            if (h.hash() != peek || h.hash() != other.hash() || other.hash_enabled()) {
+                cerr << "Failed incremental hash at " << ii << "." << endl;
+                return 1;
+            }
+        }
+        // a different permutation has a different hash, a shuffle
+        // refreshes the hash
+        mets::swap_elements(0, 1).apply(other);
+        mets::random_shuffle(pi, rng);
+        other.enable_hash();
+        if (other.hash() == pi.hash() || other.hash() != other.peek_hash_after_swap(3, 3)) {
+            cerr << "Failed hash." << endl;
+            return 1;
+        }
+        other.copy_from(pi);
+        qap check(n);
+        check.copy_from(pi);
+        if (other.hash() != pi.hash() || check.hash() != pi.hash()) {
+            cerr << "Failed hash after copy or shuffle." << endl;
+            return 1;
+        }
+    }
+
+    // test implicit_swap_neighborhood enumerates the full neighborhood
+    {
+        const int n = 11;
+        mets::swap_full_neighborhood full(n);
+        mets::implicit_swap_neighborhood implicit(n);
+        if (full.size() != implicit.size() ||
+            std::distance(implicit.begin(), implicit.end()) != (long)full.size()) {
+            cerr << "Failed implicit_swap_neighborhood size." << endl;
+            return 1;
+        }
+        mets::implicit_swap_neighborhood::iterator it = implicit.begin();
+        int k = 0;
+        for (mets::swap_full_neighborhood::iterator ft = full.begin(); ft != full.end();
+             ++ft, ++it, ++k) {
+            const mets::swap_elements &fm = static_cast<const mets::swap_elements &>(**ft);
+            mets::implicit_swap_neighborhood::iterator rt = implicit.begin() + k;
+            const mets::swap_elements &rm = **rt;
+            if (!(fm == **it) || !(fm == rm)) {
+                cerr << "Failed implicit_swap_neighborhood at " << k << "." << endl;
+                return 1;
+            }
+        }
+        if (it != implicit.end()) {
+            cerr << "Failed implicit_swap_neighborhood end." << endl;
+            return 1;
+        }
+    }
+
+    // test implicit_invert_neighborhood enumerates the full neighborhood
+    {
+        const int n = 9;
+        mets::invert_full_neighborhood full(n);
+        mets::implicit_invert_neighborhood implicit(n);
+        if (full.size() != implicit.size()) {
+            cerr << "Failed implicit_invert_neighborhood size." << endl;
+            return 1;
+        }
+        mets::implicit_invert_neighborhood::iterator it = implicit.begin();
+        int k = 0;
+        for (mets::invert_full_neighborhood::iterator ft = full.begin(); ft != full.end();
+             ++ft, ++it, ++k) {
+            const mets::invert_subsequence &fm =
+                    static_cast<const mets::invert_subsequence &>(**ft);
+            mets::implicit_invert_neighborhood::iterator rt = implicit.end() - (full.size() - k);
+            const mets::invert_subsequence &rm = **rt;
+            if (!(fm == **it) || !(fm == rm)) {
+                cerr << "Failed implicit_invert_neighborhood at " << k << "." << endl;
+                return 1;
+            }
+        }
+    }
+
+    // test random_swap_neighborhood enumerates each swap once, in a
+    // different order at each refresh
+    for (int n = 2; n < 40; n += 7) {
+        qap pi(n);
+        mets::random_swap_neighborhood random(n, 3);
+        std::vector<std::pair<int, int> > previous;
+        for (int round = 0; round != 3; ++round) {
+            random.refresh(pi);
+            std::vector<std::pair<int, int> > order;
+            mets::random_swap_neighborhood::iterator it = random.begin();
+            for (size_t k = 0; it != random.end(); ++it, ++k) {
+                mets::random_swap_neighborhood::iterator rt = random.begin() + k;
+                const mets::swap_elements &m = **it;
+                if (!(m == **rt) || m.first() >= m.second() || m.second() >= n) {
+                    cerr << "Failed random_swap_neighborhood move " << k << "." << endl;
+                    return 1;
+                }
+                order.push_back(std::make_pair(m.first(), m.second()));
+            }
+            std::vector<std::pair<int, int> > sorted(order);
+            std::sort(sorted.begin(), sorted.end());
+            if (order.size() != random.size() || order.size() != size_t(n * (n - 1) / 2) ||
+                std::unique(sorted.begin(), sorted.end()) != sorted.end() ||
+                (n > 10 && (order == sorted || order == previous))) {
+                cerr << "Failed random_swap_neighborhood order, size " << n << "." << endl;
+                return 1;
+            }
+            previous = order;
+        }
+    }
+
+    // test swap_neighborhood draws valid random swaps
+    {
+        const int n = 10;
+        qap pi(n);
+        std::minstd_rand0 rng(5);
+        mets::swap_neighborhood<std::minstd_rand0> random(rng, 25);
+        random.refresh(pi);
+        for (mets::move_manager::iterator it = random.begin(); it != random.end(); ++it) {
+            const mets::swap_elements &m = static_cast<const mets::swap_elements &>(**it);
+            if (m.first() >= m.second() || m.second() >= n) {
+                cerr << "Failed swap_neighborhood." << endl;
+                return 1;
+            }
+        }
+    }
+
     return 0;
 }
 #endif
@@ -0,0 +1,68 @@
+// a small random quadratic assignment problem shared by the tests
+#ifndef METS_TEST_QAP_HH_
+#define METS_TEST_QAP_HH_
+
+#include <metslib/mets.hh>
+
+class qap : public mets::permutation_problem {
+  public:
+    qap(int n, unsigned int seed = 12345)
+        : permutation_problem(n), flow_m(n * n), distance_m(n * n) {
+        for (int ii = 0; ii != n * n; ++ii) {
+            seed = seed * 1103515245 + 12345;
+            flow_m[ii] = (seed >> 16) % 10;
+            seed = seed * 1103515245 + 12345;
+            distance_m[ii] = (seed >> 16) % 10;
+        }
+        update_cost();
+    }
+
+    mets::gol_type compute_cost() const {
+        int n = size();
+        mets::gol_type sum = 0.0;
+        for (int ii = 0; ii != n; ++ii)
+            for (int jj = 0; jj != n; ++jj)
+                sum += flow_m[ii * n + jj] * distance_m[pi_m[ii] * n + pi_m[jj]];
+        return sum;
+    }
+
+    mets::gol_type evaluate_swap(int i, int j) const {
+        qap copy(*this);
+        std::swap(copy.pi_m[i], copy.pi_m[j]);
+        return copy.compute_cost() - compute_cost();
+    }
+
+  protected:
+    std::vector<int> flow_m;
+    std::vector<int> distance_m;
+};
+
+// the components of a search on a qap: the working solution, the
+// recorder of the best solution (equal to the working one at first),
+// the neighborhood, the tabu list, the aspiration criteria and the
+// termination criteria (the searches that need them, in the order
+// of the engine constructors)
+template <typename neighborhood_type, typename recorder_type = mets::best_ever_solution,
+          typename aspiration_type = mets::best_ever_criteria,
+          typename termination_type = mets::iteration_termination_criteria>
+struct qap_search {
+    explicit qap_search(int n, unsigned int tenure = 5, int iterations = 150,
+                        unsigned int seed = 12345)
+        : working(n, seed),
+          best(n, seed),
+          recorder(best),
+          moves(n),
+          tabus(tenure),
+          aspiration(),
+          termination(iterations) {}
+
+    qap working;
+    qap best;
+    recorder_type recorder;
+    neighborhood_type moves;
+    mets::simple_tabu_list tabus;
+    aspiration_type aspiration;
+    termination_type termination;
+};
+
+#endif
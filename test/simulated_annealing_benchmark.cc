@@ -0,0 +1,51 @@
+// simulated annealing acceptance benchmark (not a regression test)
+#include <metslib/mets.hh>
+
+using namespace std;
+
+// times the scan of a batch of mostly rejected moves
+template <typename acceptance_type>
+double scan(acceptance_type &acceptance, const std::vector<mets::gol_type> &costs,
+            unsigned int batch, long &accepted) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> ureal(0.0, 1.0);
+    auto uniform = [&]() { return ureal(rng); };
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int round = 0; round != 20; ++round) {
+        for (unsigned int first = 0; first < costs.size(); first += batch) {
+            acceptance.start(1.0);
+            unsigned int size = std::min<size_t>(batch, costs.size() - first);
+            accepted += acceptance.first(&costs[first], size, 0.0, uniform) != size;
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(void) {
+    // deltas between 5 and 25 KT: one move out of thousands accepted
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> deltas(5.0, 25.0);
+    std::vector<mets::gol_type> costs(1 << 20);
+    for (std::vector<mets::gol_type>::iterator it = costs.begin(); it != costs.end(); ++it)
+        *it = deltas(rng);
+
+    const unsigned int batch = 1024;
+    long accepted = 0;
+    mets::metropolis_acceptance metropolis;
+    double metropolis_time = scan(metropolis, costs, batch, accepted);
+    cout << "metropolis_acceptance: " << metropolis_time << " s, " << accepted
+         << " accepted batches" << endl;
+
+    // one threshold every 16 moves and one per batch (fewer draws,
+    // more correlated decisions)
+    const unsigned int shared[] = {16, batch};
+    for (unsigned int ii = 0; ii != 2; ++ii) {
+        accepted = 0;
+        mets::threshold_acceptance threshold(shared[ii]);
+        double threshold_time = scan(threshold, costs, batch, accepted);
+        cout << "threshold_acceptance(" << shared[ii] << "): " << threshold_time << " s, "
+             << accepted << " accepted batches, speedup " << metropolis_time / threshold_time
+             << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,339 @@
+// simulated annealing regression
+#include <metslib/mets.hh>
+
+#include "qap.hh"
+
+using namespace std;
+
+// the outcome of a parallel tempering run: best cost and the costs
+// of the replicas along the ladder
+typedef std::vector<mets::gol_type> outcome;
+
+outcome run_tempering(unsigned int threads) {
+    const int n = 12;
+    const int replicas = 4;
+    std::deque<qap> working;
+    std::deque<mets::implicit_swap_neighborhood> moves;
+    qap best(n);
+    mets::best_ever_solution recorder(best);
+    mets::iteration_termination_criteria termination(100);
+    mets::thread_pool pool(threads);
+    mets::parallel_tempering<mets::implicit_swap_neighborhood> search(recorder, termination, pool,
+                                                                      5.0, 200.0, 5);
+    std::mt19937 rng(7);
+    for (int ii = 0; ii != replicas; ++ii) {
+        working.emplace_back(n);
+        mets::random_shuffle(working.back(), rng);
+        moves.emplace_back(n);
+        search.add_replica(working.back(), moves.back());
+    }
+    search.search();
+
+    outcome result;
+    result.push_back(recorder.best_cost());
+    for (unsigned int slot = 0; slot != search.size(); ++slot)
+        result.push_back(search.replica(slot).cost_function());
+    // best_seen() is a consistent copy, some exchange took place
+    if (static_cast<const qap &>(recorder.best_seen()).compute_cost() != recorder.best_cost() ||
+        search.exchange_rate(0) + search.exchange_rate(1) + search.exchange_rate(2) == 0)
+        result.clear();
+    return result;
+}
+
+// the trajectory of a simulated annealing run (costs after each move,
+// with the move index and the temperature of the events); a NaN
+// marks an event inconsistent with the working solution, so that the
+// trajectory differs from any other
+template <typename neighborhood_t>
+struct trajectory_logger : public mets::search_listener<neighborhood_t> {
+    trajectory_logger()
+        : mets::search_listener<neighborhood_t>(),
+          last_m(std::numeric_limits<mets::gol_type>::quiet_NaN()),
+          costs() {}
+
+    void update(mets::abstract_search<neighborhood_t> *as) {
+        if (as->step() == mets::abstract_search<neighborhood_t>::MOVE_MADE) {
+            const mets::search_event &e = as->event();
+            mets::gol_type cost =
+                    static_cast<const mets::evaluable_solution &>(as->working()).cost_function();
+            bool consistent = e.cost == cost && (last_m != last_m || e.delta == cost - last_m) &&
+                              e.move_index >= 0 && e.parameter > 0.0;
+            costs.push_back(consistent ? cost : std::numeric_limits<mets::gol_type>::quiet_NaN());
+            costs.push_back(e.move_index);
+            costs.push_back(e.parameter);
+            last_m = cost;
+        }
+    }
+
+    mets::gol_type last_m;
+    std::vector<mets::gol_type> costs;
+};
+
+// runs a simulated annealing (speculative if a pool is given)
+template <typename acceptance_type>
+outcome run_annealing(mets::thread_pool *pool, unsigned int batch,
+                      const acceptance_type &acceptance) {
+    typedef mets::implicit_swap_neighborhood neighborhood;
+    qap_search<neighborhood> f(12, 5, 400);
+    mets::exponential_cooling cooling(0.99);
+    trajectory_logger<neighborhood> logger;
+    if (pool) {
+        mets::parallel_simulated_annealing search(f.working, f.recorder, f.moves, f.termination,
+                                                  cooling, 50.0, *pool, batch, 1e-7, 1.0,
+                                                  acceptance);
+        search.seed(1234);
+        search.attach(logger);
+        search.search();
+    } else {
+        mets::simulated_annealing search(f.working, f.recorder, f.moves, f.termination, cooling,
+                                         50.0, 1e-7, 1.0, acceptance);
+        search.seed(1234);
+        search.attach(logger);
+        search.search();
+    }
+    logger.costs.push_back(f.recorder.best_cost());
+    return logger.costs;
+}
+
+// exponential cooling recording the chains
+struct chain_recorder : public mets::exponential_cooling {
+    chain_recorder() : mets::exponential_cooling(0.9), chains() {}
+    void chain_end(const mets::chain_statistics &stats) { chains.push_back(stats); }
+    std::vector<mets::chain_statistics> chains;
+};
+
+// modified Lam schedule recording, for each chain, the measured
+// acceptance rate and the target rate of the schedule
+struct lam_recorder : public mets::lam_cooling {
+    explicit lam_recorder(unsigned long budget) : mets::lam_cooling(budget), rates() {}
+    void chain_end(const mets::chain_statistics &stats) {
+        rates.push_back(std::make_pair(stats.acceptance_rate(), target()));
+        mets::lam_cooling::chain_end(stats);
+    }
+    std::vector<std::pair<double, double> > rates;
+};
+
+// runs a simulated annealing with the given cooling schedule and
+// chain length, returns the best cost
+template <typename neighborhood = mets::implicit_swap_neighborhood>
+mets::gol_type run_chains(mets::abstract_cooling_schedule &cooling, double temp,
+                          unsigned long trials, unsigned long accepted, int iterations) {
+    qap_search<neighborhood> f(12, 5, iterations);
+    mets::simulated_annealing<neighborhood> search(f.working, f.recorder, f.moves, f.termination,
+                                                   cooling, temp);
+    search.chain_length(trials, accepted);
+    search.search();
+    return f.recorder.best_cost();
+}
+
+int main(void) {
+    // parallel tempering is reproducible whatever the number of threads
+    {
+        outcome serial = run_tempering(1);
+        if (serial.empty()) {
+            cerr << "Parallel tempering failed." << endl;
+            return 1;
+        }
+        for (unsigned int threads = 2; threads != 5; ++threads) {
+            if (run_tempering(threads) != serial) {
+                cerr << "Parallel tempering diverged with " << threads << " threads." << endl;
+                return 1;
+            }
+        }
+    }
+
+    // speculative annealing follows the serial trajectory, whatever
+    // the acceptance policy
+    {
+        mets::metropolis_acceptance metropolis;
+        mets::threshold_acceptance threshold(16);
+        outcome serial = run_annealing(0, 0, metropolis);
+        outcome serial_threshold = run_annealing(0, 0, threshold);
+        for (unsigned int threads = 1; threads != 5; ++threads) {
+            mets::thread_pool pool(threads);
+            if (run_annealing(&pool, 0, metropolis) != serial ||
+                run_annealing(&pool, 5, metropolis) != serial ||
+                run_annealing(&pool, 0, threshold) != serial_threshold ||
+                run_annealing(&pool, 5, threshold) != serial_threshold) {
+                cerr << "Speculative annealing diverged with " << threads << " threads." << endl;
+                return 1;
+            }
+        }
+    }
+
+    // both policies accept a move with the Metropolis probability
+    {
+        std::mt19937 rng(99);
+        std::uniform_real_distribution<double> ureal(0.0, 1.0);
+        auto uniform = [&]() { return ureal(rng); };
+        const double kt = 2.0;
+        const double delta = kt * std::log(2.0);  // accepted half of the times
+        const int trials = 20000;
+        mets::metropolis_acceptance metropolis;
+        mets::threshold_acceptance threshold(16);
+        metropolis.start(kt);
+        threshold.start(kt);
+        int metropolis_accepted = 0, threshold_accepted = 0;
+        for (int ii = 0; ii != trials; ++ii) {
+            metropolis_accepted += metropolis(delta, uniform);
+            threshold_accepted += threshold(delta, uniform);
+        }
+        if (std::abs(metropolis_accepted - trials / 2) > trials / 50 ||
+            std::abs(threshold_accepted - trials / 2) > trials / 50 || !threshold(-1.0, uniform)) {
+            cerr << "Acceptance probability test failed." << endl;
+            return 1;
+        }
+    }
+
+    // chain length in evaluated and accepted moves
+    {
+        const unsigned long neighborhood_size = 12 * 11 / 2;
+        chain_recorder by_trials;
+        run_chains(by_trials, 50.0, 2 * neighborhood_size, 0, 500);
+        chain_recorder by_accepted;
+        run_chains(by_accepted, 50.0, 4 * neighborhood_size, 5, 500);
+        if (by_trials.chains.size() < 2 || by_accepted.chains.size() < 2) {
+            cerr << "Too few chains." << endl;
+            return 1;
+        }
+        for (std::vector<mets::chain_statistics>::iterator it = by_trials.chains.begin();
+             it != by_trials.chains.end(); ++it)
+            if (it->trials < 2 * neighborhood_size ||
+                it->trials >= 3 * neighborhood_size) {
+                cerr << "Wrong chain length (trials)." << endl;
+                return 1;
+            }
+        for (std::vector<mets::chain_statistics>::iterator it = by_accepted.chains.begin();
+             it != by_accepted.chains.end(); ++it)
+            if (it->accepted != 5 && it->trials < 4 * neighborhood_size) {
+                cerr << "Wrong chain length (accepted)." << endl;
+                return 1;
+            }
+    }
+
+    // the modified Lam schedule keeps the acceptance rate on target
+    // and reheating restarts stalled searches
+    {
+        lam_recorder lam(40000);
+        qap start(12);
+        if (run_chains<mets::random_swap_neighborhood>(lam, 50.0, 100, 0, 8000) >=
+            start.cost_function()) {
+            cerr << "Lam schedule did not improve." << endl;
+            return 1;
+        }
+        // after a warm up the measured rate follows the target (up to
+        // the noise of chains of 100 trials), until the target gets to
+        // zero at the end of the budget
+        double error = 0.0, bias = 0.0;
+        size_t chains = 0;
+        for (size_t ii = lam.rates.size() / 20; ii != lam.rates.size(); ++ii)
+            if (lam.rates[ii].second > 0.05) {
+                error += std::abs(lam.rates[ii].first - lam.rates[ii].second);
+                bias += lam.rates[ii].first - lam.rates[ii].second;
+                ++chains;
+            }
+        if (chains < 50 || error / chains > 0.1 || std::abs(bias / chains) > 0.03) {
+            cerr << "Lam schedule missed the target acceptance rate." << endl;
+            return 1;
+        }
+        mets::exponential_cooling fast(0.5);
+        mets::reheating_cooling reheating(fast, 3, 4.0);
+        run_chains(reheating, 10.0, 66, 0, 2000);
+        if (reheating.reheats() == 0) {
+            cerr << "Reheating never happened." << endl;
+            return 1;
+        }
+    }
+
+    // each evaluated move is accepted or rejected, the speculative
+    // evaluations are counted as well
+    {
+        typedef mets::implicit_swap_neighborhood neighborhood;
+        typedef mets::search_statistics stats;
+        qap_search<neighborhood> f(12, 5, 400);
+        mets::exponential_cooling cooling(0.99);
+        mets::simulated_annealing<neighborhood> search(f.working, f.recorder, f.moves,
+                                                       f.termination, cooling, 50.0);
+        mets::perf_profiler profiler;
+        search.profiler(&profiler);
+        search.search();
+        const stats &s = search.statistics();
+        mets::thread_pool pool(3);
+        mets::iteration_termination_criteria parallel_termination(400);
+        mets::parallel_simulated_annealing<neighborhood> parallel(
+                f.working, f.recorder, f.moves, parallel_termination, cooling, 50.0, pool, 16);
+        parallel.search();
+        const stats &p = parallel.statistics();
+        if (s.get(stats::MOVES_ACCEPTED) + s.get(stats::MOVES_REJECTED) !=
+                    s.get(stats::MOVES_EVALUATED) ||
+            s.get(stats::REFRESHES) != 400 || s.get(stats::MOVES_ACCEPTED) == 0 ||
+            p.get(stats::MOVES_ACCEPTED) + p.get(stats::MOVES_REJECTED) >
+                    p.get(stats::MOVES_EVALUATED) ||
+            p.get(stats::REFRESHES) != 400 || s.get(stats::EVALUATE_NS) != 0 ||
+            profiler.counters(mets::phase_listener::EVALUATE).calls != 400 ||
+            profiler.counters(mets::phase_listener::APPLY).calls !=
+                    s.get(stats::MOVES_ACCEPTED)) {
+            cerr << "Annealing statistics or profile failed." << endl;
+            return 1;
+        }
+    }
+
+    // temperature calibration hits the target acceptance ratio
+    {
+        qap working(12);
+        mets::implicit_swap_neighborhood moves(12);
+        mets::temperature_calibration serial = mets::calibrate_temperature(working, moves, 0.6);
+        mets::thread_pool pool(3);
+        mets::temperature_calibration parallel =
+                mets::calibrate_temperature(working, moves, pool, 0.6);
+        if (serial.starting_temp != parallel.starting_temp ||
+            serial.stop_temp != parallel.stop_temp || serial.samples != parallel.samples ||
+            serial.samples == 0) {
+            cerr << "Parallel calibration differs." << endl;
+            return 1;
+        }
+
+        double sum = 0;
+        mets::gol_type smallest = std::numeric_limits<mets::gol_type>::max();
+        for (int j = 1; j != 12; ++j)
+            for (int i = 0; i != j; ++i) {
+                mets::gol_type delta = working.evaluate_swap(i, j);
+                if (delta <= 0) continue;
+                sum += std::exp(-delta / serial.starting_temp);
+                smallest = std::min(smallest, delta);
+            }
+        if (std::abs(sum / serial.samples - 0.6) > 1e-6 ||
+            std::abs(std::exp(-smallest / serial.stop_temp) - 1e-3) > 1e-9 ||
+            serial.stop_temp >= serial.starting_temp) {
+            cerr << "Wrong calibration." << endl;
+            return 1;
+        }
+
+        // larger neighborhoods are sampled, the same way by both
+        qap large(60);
+        mets::implicit_swap_neighborhood large_moves(60);
+        serial = mets::calibrate_temperature(large, large_moves, 0.6, 1e-3, 1.0, 200);
+        parallel = mets::calibrate_temperature(large, large_moves, pool, 0.6, 1e-3, 1.0, 200);
+        if (serial.starting_temp != parallel.starting_temp ||
+            serial.stop_temp != parallel.stop_temp || serial.samples != parallel.samples ||
+            serial.samples == 0 || serial.samples > 200) {
+            cerr << "Sampled calibration failed." << endl;
+            return 1;
+        }
+
+        // negligible cost changes do not set the stopping temperature
+        std::vector<mets::gol_type> deltas;
+        deltas.push_back(1e-12);
+        deltas.push_back(2.0);
+        deltas.push_back(1.0);
+        mets::temperature_calibration noisy =
+                mets::temperature_calibration::from_deltas(deltas, 0.6, 1e-3, 1.0);
+        if (noisy.samples != 2 || std::abs(std::exp(-1.0 / noisy.stop_temp) - 1e-3) > 1e-9) {
+            cerr << "Negligible cost change used in calibration." << endl;
+            return 1;
+        }
+    }
+
+    cerr << "Success!" << endl;
+    return 0;
+}
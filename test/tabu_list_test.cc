@@ -1,6 +1,9 @@
 // tabu list regression
 #include <metslib/mets.hh>
 
+#include <map>
+#include <set>
+
 using namespace std;
 
 class my_sol : public mets::evaluable_solution {
@@ -28,6 +31,29 @@ class my_move : public mets::mana_move {
     mets::gol_type evaluate(const mets::feasible_solution &) const { return 0.0; }
 };
 
+class my_permutation : public mets::permutation_problem {
+  public:
+    my_permutation(int n) : mets::permutation_problem(n) {}
+    mets::gol_type compute_cost() const { return 0.0; }
+    mets::gol_type evaluate_swap(int, int) const { return 0.0; }
+};
+
+// the k-th swap of a permutation of the given size
+mets::swap_elements kth_swap(int size, int k) {
+    int p1 = 0;
+    while (k >= size - 1 - p1) k -= size - 1 - p1++;
+    return mets::swap_elements(p1, p1 + 1 + k);
+}
+
+// a swap whose opposite is the swap of the following positions
+struct shifted_swap : public mets::swap_elements {
+    shifted_swap(int from, int to) : mets::swap_elements(from, to) {}
+
+    mets::mana_move *opposite_of() const {
+        return new mets::swap_elements(first() + 1, second() + 1);
+    }
+};
+
 int main(void) {
     // test basic correct tabu list behaviour with many different moves
     {
@@ -89,6 +115,268 @@ int main(void) {
         }
     }
 
+    // same regressions for the swap tabu matrix
+    {
+        const int size = 100;
+        const int tenure = 7;
+        const int tests = 2000;
+
+        my_sol s;
+        mets::swap_tabu_matrix tl(size, tenure);
+
+        for (int ii = 0; ii != tests; ++ii) {
+            mets::swap_elements m = kth_swap(size, ii);
+            tl.tabu(s, m);
+            for (int jj = 0; jj != tests; ++jj) {
+                mets::swap_elements tm = kth_swap(size, jj);
+                if (jj > ii - tenure && jj <= ii) {
+                    if (!tl.is_tabu(s, tm)) {
+                        cerr << "Matrix failure at ! " << ii << ", " << jj << endl;
+                        return 1;
+                    }
+                } else {
+                    if (tl.is_tabu(s, tm)) {
+                        cerr << "Matrix failure at " << ii << ", " << jj << endl;
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+
+    {
+        const int tenure = 3;
+        mets::swap_tabu_matrix tl(5, tenure);
+
+        my_sol s;
+        mets::swap_elements m1(0, 1);
+        tl.tabu(s, m1);
+        if (!tl.is_tabu(s, m1)) {
+            cerr << "Matrix Err1" << endl;
+            return 1;
+        }
+        mets::swap_elements m2(2, 1);
+        tl.tabu(s, m2);
+        tl.tabu(s, m2);
+        tl.tabu(s, m2);
+        mets::swap_elements m3(4, 3);
+        tl.tabu(s, m3);
+        tl.tabu(s, m3);
+        tl.tabu(s, m3);
+        if (!tl.is_tabu(s, m1)) {
+            cerr << "Matrix Err2" << endl;
+            return 1;
+        }
+        mets::swap_elements m4(0, 4);
+        tl.tabu(s, m4);
+        if (tl.is_tabu(s, m1)) {
+            cerr << "Matrix Err3" << endl;
+            return 1;
+        }
+    }
+
+    // renewing a move that is not the latest keeps the matrix on the
+    // simple tabu list (A, B, C, A, D with tenure 3 drops B), also on
+    // random sequences with repeated moves and changes of tenure
+    {
+        my_sol s;
+        mets::simple_tabu_list simple(3);
+        mets::swap_tabu_matrix matrix(12, 3);
+        const int sequence[][2] = {{0, 1}, {2, 3}, {4, 5}, {0, 1}, {6, 7}};
+        for (int ii = 0; ii != 5; ++ii) {
+            mets::swap_elements m(sequence[ii][0], sequence[ii][1]);
+            simple.tabu(s, m);
+            matrix.tabu(s, m);
+        }
+        mets::swap_elements b(2, 3);
+        if (matrix.is_tabu(s, b) || simple.is_tabu(s, b)) {
+            cerr << "Matrix kept an expired move" << endl;
+            return 1;
+        }
+        std::mt19937 rng(11);
+        std::uniform_int_distribution<int> position(0, 5);
+        for (int ii = 0; ii != 20000; ++ii) {
+            if (ii % 1000 == 999) {
+                unsigned int tenure = 1 + rng() % 12;
+                simple.tenure(tenure);
+                matrix.tenure(tenure);
+            }
+            int p1 = position(rng), p2 = position(rng);
+            if (p1 == p2) continue;
+            mets::swap_elements m(p1, p2);
+            simple.tabu(s, m);
+            matrix.tabu(s, m);
+            for (int jj = 1; jj != 12; ++jj)
+                for (int kk = 0; kk != jj; ++kk) {
+                    mets::swap_elements t(jj, kk);
+                    if (simple.is_tabu(s, t) != matrix.is_tabu(s, t)) {
+                        cerr << "Matrix diverged from the simple tabu list at " << ii << endl;
+                        return 1;
+                    }
+                }
+        }
+    }
+
+    // the simple tabu list honours the opposite_of() of the moves
+    // derived from the library ones
+    {
+        my_sol s;
+        mets::simple_tabu_list tl(5);
+        shifted_swap m(0, 1);
+        tl.tabu(s, m);
+        if (tl.is_tabu(s, mets::swap_elements(0, 1)) ||
+            !tl.is_tabu(s, mets::swap_elements(1, 2))) {
+            cerr << "Derived move sliced by the simple tabu list" << endl;
+            return 1;
+        }
+    }
+
+    // the flat tabu list follows the simple tabu list, with swaps and
+    // inversions, repeated moves and changes of tenure
+    {
+        my_sol s;
+        mets::simple_tabu_list simple(5);
+        mets::flat_tabu_list flat(5);
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> position(0, 11);
+        for (int ii = 0; ii != 20000; ++ii) {
+            if (ii % 1000 == 999) {
+                unsigned int tenure = 1 + rng() % 40;
+                simple.tenure(tenure);
+                flat.tenure(tenure);
+            }
+            int p1 = position(rng), p2 = position(rng);
+            if (rng() % 2) {
+                mets::swap_elements m(p1, p2);
+                simple.tabu(s, m);
+                flat.tabu(s, m);
+            } else {
+                mets::invert_subsequence m(p1, p2);
+                simple.tabu(s, m);
+                flat.tabu(s, m);
+            }
+            for (int jj = 0; jj != 12; ++jj)
+                for (int kk = 0; kk != 12; ++kk) {
+                    mets::swap_elements t(jj, kk);
+                    mets::invert_subsequence u(jj, kk);
+                    if (simple.is_tabu(s, t) != flat.is_tabu(s, t) ||
+                        simple.is_tabu(s, u) != flat.is_tabu(s, u)) {
+                        cerr << "Flat tabu list diverged at " << ii << endl;
+                        return 1;
+                    }
+                }
+        }
+    }
+
+    // the element/position list forbids the elements to go back to
+    // their positions, checked against a naive implementation
+    {
+        const int n = 9;
+        const unsigned int tenure = 4;
+        my_permutation pi(n);
+        mets::element_position_tabu_list tl(n, tenure, tenure);
+        std::map<std::pair<int, int>, int> until;
+        std::mt19937 rng(3);
+        std::uniform_int_distribution<int> position(0, n - 1);
+        for (int ii = 1; ii != 5000; ++ii) {
+            int p1 = position(rng), p2 = (p1 + 1 + position(rng) % (n - 1)) % n;
+            until[std::make_pair(pi.pi(p1), p1)] = ii + tenure;
+            until[std::make_pair(pi.pi(p2), p2)] = ii + tenure;
+            if (ii % 2) {
+                mets::swap_elements m(p1, p2);
+                tl.tabu(pi, m);
+                m.apply(pi);
+            } else {
+                mets::invert_subsequence m(p1, p2);
+                tl.tabu(pi, static_cast<const mets::move &>(m));
+                m.apply(pi);
+            }
+            for (int jj = 0; jj != n; ++jj)
+                for (int kk = jj + 1; kk != n; ++kk) {
+                    bool expected = until[std::make_pair(pi.pi(kk), jj)] > ii &&
+                                    until[std::make_pair(pi.pi(jj), kk)] > ii;
+                    mets::swap_elements t(jj, kk);
+                    mets::invert_subsequence u(kk, jj);
+                    if (tl.is_tabu(pi, t) != expected || tl.is_tabu(pi, u) != expected ||
+                        tl.is_tabu(pi, static_cast<const mets::move &>(t)) != expected) {
+                        cerr << "Element/position failure at " << ii << ", " << jj << ", " << kk
+                             << endl;
+                        return 1;
+                    }
+                }
+        }
+    }
+
+    // random tenures stay in [tmin, tmax] and take all the values
+    {
+        const int n = 6;
+        my_permutation pi(n);
+        mets::element_position_tabu_list tl(n, 3, 8, 11);
+        std::set<int> tenures;
+        for (int ii = 0; ii != 200; ++ii) {
+            mets::swap_elements m(0, 1);
+            tl.tabu(pi, m);
+            m.apply(pi);
+            // count the moves until the swap back is not tabu any more
+            int t = 0;
+            mets::swap_elements other(2 + ii % 2, 4 + ii % 2);
+            while (tl.is_tabu(pi, m)) {
+                ++t;
+                tl.tabu(pi, other);
+                if (t > 100) break;
+            }
+            tenures.insert(t);
+        }
+        // both elements must be forbidden, the min of two draws
+        if (*tenures.begin() < 3 || *tenures.rbegin() > 8 || tenures.size() < 4) {
+            cerr << "Element/position random tenure out of range" << endl;
+            return 1;
+        }
+    }
+
+    // the minimum tenure does not drift when the tenure goes up and
+    // down
+    {
+        mets::element_position_tabu_list tl(6, 3, 8);
+        for (int ii = 0; ii != 100; ++ii) {
+            tl.tenure(5 + ii % 7);
+            tl.tenure(2 + ii % 3);
+        }
+        tl.tenure(8);
+        if (tl.min_tenure() != 3) {
+            cerr << "Element/position minimum tenure drifted to " << tl.min_tenure() << endl;
+            return 1;
+        }
+    }
+
+    // moves without a key can not be used with the flat tabu list
+    {
+        my_sol s;
+        mets::flat_tabu_list flat(5);
+        my_move m(1);
+        try {
+            flat.tabu(s, m);
+            cerr << "Flat tabu list accepted a move without key" << endl;
+            return 1;
+        } catch (const std::runtime_error &) {
+        }
+    }
+
+    // the swaps of large permutations do not collide
+    {
+        const int size = 200000;
+        std::vector<size_t> hashes;
+        for (int ii = 0; ii != 1000; ++ii) {
+            hashes.push_back(mets::swap_elements(ii, size - 1 - ii).hash());
+            hashes.push_back(mets::swap_elements(ii, ii + 65536).hash());
+        }
+        std::sort(hashes.begin(), hashes.end());
+        if (std::unique(hashes.begin(), hashes.end()) != hashes.end()) {
+            cerr << "Swap hash collision" << endl;
+            return 1;
+        }
+    }
+
     cerr << "Success!" << endl;
     return 0;
 }
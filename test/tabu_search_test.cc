@@ -0,0 +1,575 @@
+// tabu search regression
+#include <metslib/mets.hh>
+
+#include "qap.hh"
+
+#include <memory>
+
+using namespace std;
+
+template <typename neighborhood_t>
+struct trajectory_logger : public mets::search_listener<neighborhood_t> {
+    trajectory_logger() : mets::search_listener<neighborhood_t>(), events() {}
+
+    void update(mets::abstract_search<neighborhood_t> *as) {
+        events.push_back(std::make_pair(
+                as->step(), static_cast<const mets::evaluable_solution &>(as->working())
+                                    .cost_function()));
+    }
+
+    std::vector<std::pair<int, mets::gol_type> > events;
+};
+
+// runs a tabu search (parallel if a pool is given) and returns the
+// observed trajectory
+template <typename neighborhood>
+std::vector<std::pair<int, mets::gol_type> > run(mets::thread_pool *pool) {
+    qap_search<neighborhood> f(14);
+    trajectory_logger<neighborhood> logger;
+
+    if (pool) {
+        mets::parallel_tabu_search<neighborhood> search(f.working, f.recorder, f.moves, f.tabus,
+                                                        f.aspiration, f.termination, *pool);
+        search.attach(logger);
+        search.search();
+    } else {
+        mets::tabu_search<neighborhood> search(f.working, f.recorder, f.moves, f.tabus,
+                                               f.aspiration, f.termination);
+        search.attach(logger);
+        search.search();
+    }
+    logger.events.push_back(std::make_pair(-1, f.recorder.best_cost()));
+    return logger.events;
+}
+
+// checks the event of each move against the working solution and
+// records it
+template <typename neighborhood_t>
+struct event_checker : public mets::search_listener<neighborhood_t> {
+    typedef mets::abstract_search<neighborhood_t> search_type;
+
+    event_checker(int moves, unsigned int tenure)
+        : mets::search_listener<neighborhood_t>(),
+          moves_m(moves),
+          tenure_m(tenure),
+          iteration_m(0),
+          cost_m(),
+          failed(false),
+          events() {}
+
+    void update(search_type *as) {
+        const mets::search_event &e = as->event();
+        if (e.step != as->step() || e.iteration != iteration_m + (e.step == as->ITERATION_BEGIN))
+            failed = true;
+        if (as->step() == search_type::ITERATION_BEGIN) {
+            iteration_m = e.iteration;
+            cost_m = e.cost;
+        } else if (as->step() == mets::tabu_search<neighborhood_t>::ASPIRATION_CRITERIA_MET) {
+            if (!e.tabu || !e.aspiration || e.move_index < 0 || e.move_index >= moves_m)
+                failed = true;
+        } else if (as->step() == search_type::MOVE_MADE) {
+            mets::gol_type cost =
+                    static_cast<const mets::evaluable_solution &>(as->working()).cost_function();
+            if (e.cost != cost || e.delta != cost - cost_m || e.move_index < 0 ||
+                e.move_index >= moves_m || e.tabu != e.aspiration || e.parameter != tenure_m)
+                failed = true;
+            events.push_back(std::make_pair(e.move_index, e.delta));
+        }
+    }
+
+    int moves_m;
+    unsigned int tenure_m;
+    unsigned long iteration_m;
+    mets::gol_type cost_m;
+    bool failed;
+    std::vector<std::pair<long, mets::gol_type> > events;
+};
+
+// runs a tabu search (parallel if a pool is given), returns the moves
+// seen in the events or an empty vector if they were inconsistent
+std::vector<std::pair<long, mets::gol_type> > run_events(mets::thread_pool *pool) {
+    typedef mets::swap_full_neighborhood neighborhood;
+    const int n = 14;
+    qap_search<neighborhood> f(n);
+    event_checker<neighborhood> checker(n * (n - 1) / 2, 5);
+
+    if (pool) {
+        mets::parallel_tabu_search<neighborhood> search(f.working, f.recorder, f.moves, f.tabus,
+                                                        f.aspiration, f.termination, *pool);
+        search.attach(checker);
+        search.search();
+    } else {
+        mets::tabu_search<neighborhood> search(f.working, f.recorder, f.moves, f.tabus,
+                                               f.aspiration, f.termination);
+        search.attach(checker);
+        search.search();
+    }
+    if (checker.failed || checker.events.size() != 150) checker.events.clear();
+    return checker.events;
+}
+
+// runs a tabu search (parallel if a pool is given) and returns its
+// counters, timed or not
+std::vector<unsigned long long> run_statistics(mets::thread_pool *pool, bool timing) {
+    typedef mets::swap_full_neighborhood neighborhood;
+    qap_search<neighborhood> f(14);
+    trajectory_logger<neighborhood> logger;
+    std::unique_ptr<mets::tabu_search<neighborhood> > search;
+    if (pool)
+        search.reset(new mets::parallel_tabu_search<neighborhood>(
+                f.working, f.recorder, f.moves, f.tabus, f.aspiration, f.termination, *pool));
+    else
+        search.reset(new mets::tabu_search<neighborhood>(f.working, f.recorder, f.moves, f.tabus,
+                                                         f.aspiration, f.termination));
+    search->attach(logger);
+    search->statistics().timing(timing);
+    search->search();
+    std::vector<unsigned long long> counters;
+    for (int ii = 0; ii != mets::search_statistics::COUNTERS; ++ii)
+        counters.push_back(search->statistics().get(mets::search_statistics::counter(ii)));
+    return counters;
+}
+
+// runs a tabu search with the given observer policy and a logger
+// subscribed to the given events, returns the events seen by the
+// logger and by a second logger subscribed to all the events
+template <typename observer_policy>
+std::pair<std::vector<std::pair<int, mets::gol_type> >,
+          std::vector<std::pair<int, mets::gol_type> > >
+run_observed(unsigned int events) {
+    typedef mets::implicit_swap_neighborhood neighborhood;
+    qap_search<neighborhood> f(14);
+    trajectory_logger<neighborhood> logger, all;
+
+    mets::tabu_search<neighborhood, mets::feasible_solution, mets::solution_recorder,
+                      mets::tabu_list_chain, mets::aspiration_criteria_chain,
+                      mets::termination_criteria_chain, observer_policy>
+            search(f.working, f.recorder, f.moves, f.tabus, f.aspiration, f.termination);
+    search.attach(all, 0);
+    search.attach(logger, events);
+    search.attach(all);
+    search.search();
+    logger.events.push_back(std::make_pair(-1, f.recorder.best_cost()));
+    all.events.push_back(std::make_pair(-1, f.recorder.best_cost()));
+    return std::make_pair(logger.events, all.events);
+}
+
+// the same tabu search as run<mets::implicit_swap_neighborhood>(0),
+// instantiated on the concrete types
+std::vector<std::pair<int, mets::gol_type> > run_typed() {
+    typedef mets::termination_any<mets::iteration_termination_criteria> termination_type;
+    qap_search<mets::implicit_swap_neighborhood, mets::basic_best_ever_solution<qap>,
+               mets::basic_best_ever_criteria<qap>, termination_type>
+            f(14);
+    trajectory_logger<mets::implicit_swap_neighborhood> logger;
+
+    mets::tabu_search search(f.working, f.recorder, f.moves, f.tabus, f.aspiration,
+                             f.termination);
+    static_assert(std::is_same<decltype(search),
+                               mets::tabu_search<mets::implicit_swap_neighborhood, qap,
+                                                 mets::basic_best_ever_solution<qap>,
+                                                 mets::simple_tabu_list,
+                                                 mets::basic_best_ever_criteria<qap>,
+                                                 termination_type> >::value,
+                  "tabu_search template arguments not deduced");
+    search.attach(logger);
+    search.search();
+    logger.events.push_back(std::make_pair(-1, f.recorder.best_cost()));
+    return logger.events;
+}
+
+// local search instantiated on the concrete types or on the
+// abstract ones, returns the local optimum cost
+template <bool typed>
+mets::gol_type run_local() {
+    qap_search<mets::implicit_swap_neighborhood, mets::basic_best_ever_solution<qap> > f(14);
+    if (typed) {
+        mets::local_search search(f.working, f.recorder, f.moves);
+        search.search();
+    } else {
+        mets::local_search<mets::implicit_swap_neighborhood> search(f.working, f.recorder,
+                                                                    f.moves);
+        search.search();
+    }
+    return f.recorder.best_cost();
+}
+
+// requests a stop at the end of the given iteration
+template <typename neighborhood_t>
+struct stopper : public mets::search_listener<neighborhood_t> {
+    stopper(mets::cancellation_source &source, int iteration)
+        : mets::search_listener<neighborhood_t>(), source_m(source), left_m(iteration) {}
+
+    void update(mets::abstract_search<neighborhood_t> *as) {
+        if (as->step() == mets::abstract_search<neighborhood_t>::ITERATION_END && --left_m == 0)
+            source_m.request_stop();
+    }
+
+    mets::cancellation_source &source_m;
+    int left_m;
+};
+
+// counts the ITERATION_END steps of a trajectory
+int iterations(const std::vector<std::pair<int, mets::gol_type> > &events) {
+    int count = 0;
+    for (auto e : events)
+        if (e.first == mets::abstract_search<mets::implicit_swap_neighborhood>::ITERATION_END)
+            ++count;
+    return count;
+}
+
+// runs a tabu search stopped by a cancellation token, returns false
+// on failure
+bool run_cancelled() {
+    typedef mets::implicit_swap_neighborhood neighborhood;
+    // the cap only stops the search if the cancellation is broken
+    const int cap = 100000;
+    qap_search<neighborhood> f(14, 5, cap);
+    mets::cancellation_source source;
+    stopper<neighborhood> stop(source, 20);
+    trajectory_logger<neighborhood> logger;
+
+    mets::tabu_search<neighborhood> search(f.working, f.recorder, f.moves, f.tabus,
+                                           f.aspiration, f.termination);
+    search.attach(stop);
+    search.attach(logger);
+    search.cancellation(source.token());
+    search.search();
+
+    // stopped at the iteration boundary, the recorder is up to date
+    mets::gol_type best_cost = std::numeric_limits<mets::gol_type>::max();
+    for (auto e : logger.events) best_cost = std::min(best_cost, e.second);
+    if (iterations(logger.events) != 20 || f.recorder.best_cost() > best_cost) return false;
+
+    // a stop requested from another thread, while the search runs
+    source.reset();
+    logger.events.clear();
+    mets::cancellation_source other;
+    search.cancellation(other.token());
+    std::thread canceller([&other]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        other.request_stop();
+    });
+    search.search();
+    canceller.join();
+    const int done = iterations(logger.events);
+    if (!other.stop_requested() || done == 0 || done >= cap / 2) return false;
+
+    // a stop requested by a signal
+    mets::cancellation_source signalled;
+    {
+        mets::signal_cancellation bridge(signalled);
+        std::raise(SIGINT);
+    }
+    return signalled.stop_requested() && !source.stop_requested();
+}
+
+// a profiler whose counters can not be read
+struct unreadable_profiler : public mets::perf_profiler {
+    unreadable_profiler() : mets::perf_profiler(false) {
+        opened_m = 1;
+        order_m[0] = CYCLES;
+    }
+};
+
+// runs a tabu search trapped by a tenure that can not grow enough,
+// returns the number of escapes
+unsigned long run_escapes() {
+    typedef mets::implicit_swap_neighborhood neighborhood;
+    qap_search<neighborhood> f(10, 1, 2000);
+    mets::reactive_tabu_listener<neighborhood> reaction(f.tabus, 1, 2, 3, 2, 2);
+    mets::tabu_search<neighborhood> search(f.working, f.recorder, f.moves, f.tabus,
+                                           f.aspiration, f.termination);
+    search.attach(reaction, search.step_mask(search.MOVE_MADE));
+    search.search();
+    return reaction.escapes();
+}
+
+// runs a tabu search with a too short tenure, made reactive, returns
+// false on failure
+template <typename neighborhood>
+bool run_reactive(mets::gol_type &fixed, mets::gol_type &reactive) {
+    const int n = 14;
+    for (int pass = 0; pass != 2; ++pass) {
+        qap_search<neighborhood> f(n, 1, 1000);
+        mets::reactive_tabu_listener<neighborhood> reaction(f.tabus, 1, n, 7);
+        mets::tabu_search<neighborhood> search(f.working, f.recorder, f.moves, f.tabus,
+                                               f.aspiration, f.termination);
+        if (pass) search.attach(reaction, search.step_mask(search.MOVE_MADE));
+        search.search();
+        (pass ? reactive : fixed) = f.recorder.best_cost();
+        if (!pass) continue;
+
+        // the incremental hash followed the moves and the walks
+        qap check(n);
+        check.copy_from(f.working);
+        if (!f.working.hash_enabled() || check.hash_enabled() ||
+            reaction.hash() != check.hash() || f.working.hash() != check.hash() ||
+            reaction.repetitions() == 0 || f.tabus.tenure() < 1 ||
+            f.tabus.tenure() > unsigned(n) || f.best.compute_cost() != f.recorder.best_cost())
+            return false;
+    }
+    return true;
+}
+
+// runs four tabu search islands from different starting points and
+// with different tenures, returns false on failure
+bool run_islands(mets::island_search<mets::implicit_swap_neighborhood>::topology_type topology) {
+    typedef mets::implicit_swap_neighborhood neighborhood;
+    typedef mets::tabu_search<neighborhood> search_type;
+    const int n = 14;
+    const int islands = 4;
+    std::deque<qap> working, best, elite, inbox;
+    std::deque<mets::best_ever_solution> recorders;
+    std::deque<neighborhood> moves;
+    std::deque<mets::simple_tabu_list> tabus;
+    std::deque<mets::best_ever_criteria> aspiration;
+    std::deque<mets::iteration_termination_criteria> termination;
+    std::deque<search_type> searches;
+
+    qap overall(n);
+    mets::best_ever_solution recorder(overall);
+    mets::island_search<neighborhood> model(recorder, 10, topology);
+    std::mt19937 rng(42);
+    for (int ii = 0; ii != islands; ++ii) {
+        working.emplace_back(n);
+        mets::random_shuffle(working.back(), rng);
+        best.emplace_back(n);
+        best.back().copy_from(working.back());
+        elite.emplace_back(n);
+        inbox.emplace_back(n);
+        recorders.emplace_back(best.back());
+        moves.emplace_back(n);
+        tabus.emplace_back(3 + ii);
+        aspiration.emplace_back();
+        termination.emplace_back(200);
+        searches.emplace_back(working.back(), recorders.back(), moves.back(), tabus.back(),
+                              aspiration.back(), termination.back());
+        model.add_island(searches.back(), elite.back(), inbox.back());
+    }
+    model.search();
+
+    // the recorder got the best of the islands, copied consistently
+    const qap &found = static_cast<const qap &>(recorder.best_seen());
+    if (found.compute_cost() != recorder.best_cost() ||
+        model.best_cost() != recorder.best_cost() || model.migrations() == 0)
+        return false;
+    for (int ii = 0; ii != islands; ++ii)
+        if (recorders[ii].best_cost() < recorder.best_cost() ||
+            elite[ii].compute_cost() != elite[ii].cost_function())
+            return false;
+    return true;
+}
+
+// runs four simulated annealing islands, returns the number of
+// migrations
+unsigned long run_annealing_islands() {
+    typedef mets::implicit_swap_neighborhood neighborhood;
+    typedef mets::simulated_annealing<neighborhood> search_type;
+    const int n = 14;
+    const int islands = 4;
+    std::deque<qap> working, best, elite, inbox;
+    std::deque<mets::best_ever_solution> recorders;
+    std::deque<neighborhood> moves;
+    std::deque<mets::iteration_termination_criteria> termination;
+    std::deque<mets::exponential_cooling> cooling;
+    std::deque<search_type> searches;
+
+    qap overall(n);
+    mets::best_ever_solution recorder(overall);
+    mets::island_search<neighborhood> model(recorder, 5);
+    std::mt19937 rng(42);
+    for (int ii = 0; ii != islands; ++ii) {
+        working.emplace_back(n);
+        mets::random_shuffle(working.back(), rng);
+        best.emplace_back(n);
+        best.back().copy_from(working.back());
+        elite.emplace_back(n);
+        inbox.emplace_back(n);
+        recorders.emplace_back(best.back());
+        moves.emplace_back(n);
+        termination.emplace_back(1000);
+        cooling.emplace_back(0.995);
+        searches.emplace_back(working.back(), recorders.back(), moves.back(),
+                              termination.back(), cooling.back(), 20.0);
+        searches.back().seed(ii);
+        model.add_island(searches.back(), elite.back(), inbox.back());
+    }
+    model.search();
+    return model.migrations();
+}
+
+int main(void) {
+    // the parallel search must follow exactly the serial trajectory,
+    // whatever the number of threads
+    {
+        std::vector<std::pair<int, mets::gol_type> > serial = run<mets::swap_full_neighborhood>(0);
+        for (unsigned int threads = 1; threads != 5; ++threads) {
+            mets::thread_pool pool(threads);
+            if (run<mets::swap_full_neighborhood>(&pool) != serial) {
+                cerr << "Parallel tabu search diverged with " << threads << " threads." << endl;
+                return 1;
+            }
+        }
+    }
+
+    // the implicit neighborhood generates the same moves in the same order
+    {
+        std::vector<std::pair<int, mets::gol_type> > serial = run<mets::swap_full_neighborhood>(0);
+        mets::thread_pool pool(3);
+        if (run<mets::implicit_swap_neighborhood>(0) != serial ||
+            run<mets::implicit_swap_neighborhood>(&pool) != serial) {
+            cerr << "Implicit neighborhood diverged." << endl;
+            return 1;
+        }
+    }
+
+    // the statically typed engines follow the same trajectory
+    {
+        if (run_typed() != run<mets::implicit_swap_neighborhood>(0)) {
+            cerr << "Statically typed tabu search diverged." << endl;
+            return 1;
+        }
+        if (run_local<true>() != run_local<false>()) {
+            cerr << "Statically typed local search diverged." << endl;
+            return 1;
+        }
+    }
+
+    // the listeners only see the events they subscribed to, and
+    // nothing with the null observer policy
+    {
+        typedef mets::abstract_search<mets::implicit_swap_neighborhood> search_type;
+        typedef std::vector<std::pair<int, mets::gol_type> > events_type;
+        const unsigned int moves = search_type::step_mask(search_type::MOVE_MADE) |
+                                   search_type::step_mask(search_type::IMPROVEMENT_MADE);
+        std::pair<events_type, events_type> observed =
+                run_observed<mets::attached_observers>(moves);
+        std::pair<events_type, events_type> ignored = run_observed<mets::null_observer>(~0u);
+        events_type expected;
+        for (auto e : observed.second)
+            if (e.first == -1 || e.first == search_type::MOVE_MADE ||
+                e.first == search_type::IMPROVEMENT_MADE)
+                expected.push_back(e);
+        if (observed.second != run<mets::implicit_swap_neighborhood>(0) ||
+            observed.first != expected || ignored.first.size() != 1 ||
+            ignored.second.size() != 1 || ignored.first.back() != observed.first.back()) {
+            cerr << "Observer event masks failed." << endl;
+            return 1;
+        }
+    }
+
+    // the counters of the serial and parallel searches are the same,
+    // the phases are timed only on request
+    {
+        typedef mets::search_statistics stats;
+        std::vector<unsigned long long> serial = run_statistics(0, true);
+        mets::thread_pool pool(3);
+        std::vector<unsigned long long> parallel = run_statistics(&pool, false);
+        bool failed = serial[stats::MOVES_EVALUATED] != 150 * 91 ||
+                      serial[stats::REFRESHES] != 150 || serial[stats::MOVES_ACCEPTED] != 150 ||
+                      serial[stats::MOVES_REJECTED] != 0 || serial[stats::IMPROVEMENTS] == 0 ||
+                      serial[stats::TABU_HITS] == 0 || serial[stats::EVALUATE_NS] == 0 ||
+                      serial[stats::TABU_NS] == 0 || serial[stats::NOTIFY_NS] == 0;
+        for (int ii = 0; ii != stats::COUNTERS; ++ii)
+            if (ii < stats::REFRESH_NS ? parallel[ii] != serial[ii] : parallel[ii] != 0)
+                failed = true;
+        if (failed) {
+            cerr << "Search statistics failed." << endl;
+            return 1;
+        }
+    }
+
+    // the profiler sees each phase once per iteration (and counts the
+    // hardware events when the system allows it)
+    {
+        typedef mets::implicit_swap_neighborhood neighborhood;
+        qap_search<neighborhood> f(14);
+        mets::tabu_search<neighborhood> search(f.working, f.recorder, f.moves, f.tabus,
+                                               f.aspiration, f.termination);
+        mets::perf_profiler profiler;
+        search.profiler(&profiler);
+        search.search();
+        qap local(14);
+        mets::local_search<neighborhood> descent(local, f.recorder, f.moves);
+        mets::perf_profiler local_profiler(false);
+        descent.profiler(&local_profiler);
+        descent.search();
+        typedef mets::phase_listener phase;
+        const mets::perf_profiler::phase_counters &evaluate = profiler.counters(phase::EVALUATE);
+        bool failed = local_profiler.available() ||
+                      local_profiler.counters(phase::REFRESH).calls !=
+                              local_profiler.counters(phase::APPLY).calls + 1 ||
+                      local_profiler.counters(phase::EVALUATE).calls !=
+                              local_profiler.counters(phase::REFRESH).calls ||
+                      evaluate.time_ns == 0 ||
+                      (profiler.available(mets::perf_profiler::INSTRUCTIONS) &&
+                       evaluate.events[mets::perf_profiler::INSTRUCTIONS] == 0);
+        for (int p = 0; p != phase::PHASES; ++p)
+            if (profiler.counters(p).calls != 150) failed = true;
+        if (failed) {
+            cerr << "Phase profiler failed." << endl;
+            return 1;
+        }
+    }
+
+#if defined(__linux__)
+    // the phases whose counters could not be read are left out
+    {
+        unreadable_profiler profiler;
+        profiler.phase_begin(mets::phase_listener::APPLY);
+        profiler.phase_end(mets::phase_listener::APPLY);
+        const mets::perf_profiler::phase_counters &apply =
+                profiler.counters(mets::phase_listener::APPLY);
+        if (apply.calls != 1 || apply.unread != 1 ||
+            apply.events[mets::perf_profiler::CYCLES] != 0) {
+            cerr << "Phase profiler counted an unread phase." << endl;
+            return 1;
+        }
+    }
+#endif
+
+    // the events describe the moves, the same ones in parallel
+    {
+        std::vector<std::pair<long, mets::gol_type> > serial = run_events(0);
+        mets::thread_pool pool(3);
+        if (serial.empty() || run_events(&pool) != serial) {
+            cerr << "Search events inconsistent." << endl;
+            return 1;
+        }
+    }
+
+    if (!run_islands(mets::island_search<mets::implicit_swap_neighborhood>::RING) ||
+        !run_islands(mets::island_search<mets::implicit_swap_neighborhood>::BROADCAST_BEST)) {
+        cerr << "Island search failed." << endl;
+        return 1;
+    }
+
+    if (run_annealing_islands() == 0) {
+        cerr << "Simulated annealing islands never migrated." << endl;
+        return 1;
+    }
+
+    {
+        mets::gol_type fixed, reactive, fixed_invert, reactive_invert;
+        if (!run_reactive<mets::implicit_swap_neighborhood>(fixed, reactive) ||
+            !run_reactive<mets::implicit_invert_neighborhood>(fixed_invert, reactive_invert) ||
+            reactive > fixed) {
+            cerr << "Reactive tabu search failed." << endl;
+            return 1;
+        }
+    }
+
+    if (run_escapes() == 0) {
+        cerr << "Reactive tabu search never escaped." << endl;
+        return 1;
+    }
+
+    if (!run_cancelled()) {
+        cerr << "Cancellation failed." << endl;
+        return 1;
+    }
+
+    cerr << "Success!" << endl;
+    return 0;
+}
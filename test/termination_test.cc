@@ -9,6 +9,13 @@ class zero_sol : public mets::evaluable_solution {
     void copy_from(const mets::copyable &) {}
 };
 
+class one_sol : public mets::evaluable_solution {
+  public:
+    mets::gol_type cost_function() const { return 1.0; }
+
+    void copy_from(const mets::copyable &) {}
+};
+
 int main(void) {
     zero_sol s;
 
@@ -33,6 +40,114 @@ int main(void) {
         return -1;
     }
 
+    {
+        typedef mets::termination_any<mets::iteration_termination_criteria,
+                                      mets::noimprove_termination_criteria>
+                any_type;
+        any_type any(10, 5);
+        count = 0;
+        while (!any(s)) count++;
+        if (count != 5) {
+            cerr << "Failed termination_any test." << endl;
+            return -1;
+        }
+
+        // terminates when both criteria are met
+        mets::termination_all<mets::iteration_termination_criteria,
+                              mets::noimprove_termination_criteria>
+                all(10, 5);
+        for (int round = 0; round != 2; ++round) {
+            count = 0;
+            while (!all(s)) count++;
+            if (count != 10 || all.get<1>().iteration() != 5) {
+                cerr << "Failed termination_all test." << endl;
+                return -1;
+            }
+            all.reset();
+        }
+
+        // the adapter chains like any other criterion
+        any.reset();
+        mets::termination_criteria_adapter<any_type> adapter(any);
+        mets::iteration_termination_criteria head(&adapter, 3);
+        count = 0;
+        while (!head(s)) count++;
+        if (count != 3) {
+            cerr << "Failed termination_criteria_adapter test." << endl;
+            return -1;
+        }
+        count = 0;
+        head.reset();
+        mets::iteration_termination_criteria longer(&adapter, 30);
+        while (!longer(s)) count++;
+        if (count != 5) {
+            cerr << "Failed termination_criteria_adapter chain test." << endl;
+            return -1;
+        }
+    }
+
+    // time budget: terminates after the deadline, reading the clock
+    // much less often than once per iteration, and can be reused
+    {
+        typedef std::chrono::steady_clock clock;
+        mets::deadline_termination_criteria deadline(std::chrono::milliseconds(50));
+        for (int round = 0; round != 2; ++round) {
+            clock::time_point start = clock::now();
+            volatile double work = 0;
+            long iterations = 0;
+            while (!deadline(s)) {
+                for (int ii = 0; ii != 100; ++ii) work = work + ii;
+                ++iterations;
+            }
+            clock::duration elapsed = clock::now() - start;
+            if (elapsed < std::chrono::milliseconds(50) ||
+                elapsed > std::chrono::milliseconds(1000)) {
+                cerr << "Failed deadline test." << endl;
+                return -1;
+            }
+            if (deadline.clock_reads() * 10 > static_cast<unsigned long>(iterations)) {
+                cerr << "Deadline read the clock " << deadline.clock_reads() << " times in "
+                     << iterations << " iterations." << endl;
+                return -1;
+            }
+            deadline.reset();
+        }
+
+        // chained after an iteration criterion
+        mets::cpu_time_termination_criteria cpu(std::chrono::seconds(60));
+        mets::iteration_termination_criteria chain(&cpu, 1000);
+        count = 0;
+        while (!chain(s)) count++;
+        if (count != 1000 || cpu.clock_reads() == 0) {
+            cerr << "Failed cpu time chain test." << endl;
+            return -1;
+        }
+    }
+
+    // the virtual entry points still check the type of the solution
+    {
+        mets::feasible_solution other;
+        mets::termination_criteria_chain &chain = days;
+        one_sol best;
+        mets::basic_best_ever_solution<one_sol> recorder(best);
+        mets::solution_recorder &base = recorder;
+        int caught = 0;
+        try {
+            chain(other);
+        } catch (const std::bad_cast &) {
+            ++caught;
+        }
+        try {
+            base.accept(s);
+        } catch (const std::bad_cast &) {
+            ++caught;
+        }
+        if (caught != 2) {
+            cerr << "Wrong solution type accepted." << endl;
+            return 1;
+        }
+    }
+
     cerr << "Success!" << endl;
     return 0;
 }
@@ -0,0 +1,119 @@
+// trace regression: the binary trace holds the events of the search
+#include <metslib/mets.hh>
+
+#include "qap.hh"
+
+#include <sstream>
+
+using namespace std;
+
+// records the events of the moves
+template <typename neighborhood_t>
+struct event_logger : public mets::search_listener<neighborhood_t> {
+    event_logger() : mets::search_listener<neighborhood_t>(), events() {}
+
+    void update(mets::abstract_search<neighborhood_t> *as) { events.push_back(as->event()); }
+
+    std::vector<mets::search_event> events;
+};
+
+// the ring keeps the records in order and never holds more than its
+// capacity
+bool check_ring() {
+    mets::trace_ring ring(5);
+    if (ring.capacity() != 8) return false;
+    mets::trace_record r = mets::trace_record(), out[8];
+    for (int round = 0; round != 3; ++round) {
+        for (int ii = 0; ii != 9; ++ii) {
+            r.iteration = round * 100 + ii;
+            if (ring.push(r) != (ii < 8)) return false;
+        }
+        if (ring.pop(out, 3) != 3 || ring.pop(out + 3, 8) != 5 || ring.pop(out, 8) != 0)
+            return false;
+        for (int ii = 0; ii != 8; ++ii)
+            if (out[ii].iteration != static_cast<std::uint64_t>(round * 100 + ii)) return false;
+    }
+    return true;
+}
+
+int main(void) {
+    if (!check_ring()) {
+        cerr << "Trace ring failed." << endl;
+        return 1;
+    }
+
+    typedef mets::implicit_swap_neighborhood neighborhood;
+    const char *path = "trace_test.trace";
+    const int n = 12;
+    event_logger<neighborhood> logger;
+    unsigned long written;
+    {
+        qap_search<neighborhood> f(n, 5, 500, 4321);
+        mets::tabu_search<neighborhood> search(f.working, f.recorder, f.moves, f.tabus,
+                                               f.aspiration, f.termination);
+        mets::trace_writer writer(path);
+        mets::trace_listener<neighborhood> tracer(writer);
+        const unsigned int mask =
+                search.step_mask(search.MOVE_MADE) | search.step_mask(search.IMPROVEMENT_MADE);
+        search.attach(tracer, mask);
+        search.attach(logger, mask);
+        search.search();
+        writer.close();
+        written = writer.written();
+        if (writer.dropped() != 0 || written != logger.events.size()) {
+            cerr << "Trace writer lost " << writer.dropped() << " records." << endl;
+            return 1;
+        }
+    }
+
+    // the file holds the events, in order
+    std::vector<mets::trace_record> records;
+    {
+        std::ifstream is(path, std::ios::binary);
+        mets::read_trace(is, records);
+    }
+    if (records.size() != written) {
+        cerr << "Trace file holds " << records.size() << " records." << endl;
+        return 1;
+    }
+    for (size_t ii = 0; ii != records.size(); ++ii) {
+        const mets::trace_record &r = records[ii];
+        const mets::search_event &e = logger.events[ii];
+        if (r.step != e.step || r.iteration != e.iteration || r.cost != e.cost ||
+            r.delta != e.delta || r.move_index != e.move_index || r.parameter != e.parameter ||
+            bool(r.flags & mets::trace_record::TABU) != e.tabu ||
+            (ii && r.timestamp < records[ii - 1].timestamp)) {
+            cerr << "Trace record " << ii << " differs from its event." << endl;
+            return 1;
+        }
+    }
+
+    // one CSV line per record, and valid looking Chrome traces
+    {
+        std::ostringstream csv, chrome;
+        mets::write_trace_csv(csv, records);
+        mets::write_chrome_trace(chrome, records);
+        std::string text = csv.str();
+        if (std::count(text.begin(), text.end(), '\n') != long(records.size()) + 1 ||
+            chrome.str().compare(0, 16, "{\"traceEvents\":[") != 0 ||
+            chrome.str().find("nan") != std::string::npos) {
+            cerr << "Trace conversion failed." << endl;
+            return 1;
+        }
+    }
+
+    // other files are rejected
+    {
+        std::istringstream is("not a trace at all");
+        try {
+            mets::read_trace(is, records);
+            cerr << "Bad trace accepted." << endl;
+            return 1;
+        } catch (const std::runtime_error &) {
+        }
+    }
+
+    std::remove(path);
+    cerr << "Success!" << endl;
+    return 0;
+}
@@ -0,0 +1,30 @@
+// converts a binary search trace (see mets::trace_writer) to CSV or
+// to the Chrome trace event format
+#include <metslib/mets.hh>
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+    string format = argc == 3 ? argv[1] : "";
+    if (argc != 3 || (format != "--csv" && format != "--chrome")) {
+        cerr << "Usage: " << argv[0] << " --csv|--chrome TRACE > OUTPUT" << endl;
+        return 2;
+    }
+    ifstream is(argv[2], ios::binary);
+    if (!is) {
+        cerr << "Unable to open " << argv[2] << endl;
+        return 1;
+    }
+    vector<mets::trace_record> records;
+    try {
+        mets::read_trace(is, records);
+    } catch (const std::runtime_error &e) {
+        cerr << argv[2] << ": " << e.what() << endl;
+        return 1;
+    }
+    if (format == "--csv")
+        mets::write_trace_csv(cout, records);
+    else
+        mets::write_chrome_trace(cout, records);
+    return cout ? 0 : 1;
+}